@@ -0,0 +1,113 @@
+#ifndef CALLSITELIMITER_HPP
+#define CALLSITELIMITER_HPP
+
+#include <chrono>
+#include <cstdint>
+
+#include "Macros.hpp"
+
+namespace SNJ {
+
+  /**
+   * Per call site, per thread filters used by the LOG_*_RATELIMITED / _SAMPLED / _EVERY_N macros.
+   * Each macro expansion owns a `static thread_local` instance, so the state is never shared
+   * between cores and the check runs before any argument is evaluated or copied.
+   */
+
+  /**
+   * @brief Fixed one-second window limiter, the first window starting with the first record.
+   *
+   * Both the allowed and the rejected paths are an increment and a compare or two. The clock
+   * is only read for the first record of a window and for every kRejectionsPerClockRead-th
+   * rejection, the first one included, so a flooding site notices that its window is over
+   * within that many records rather than paying a clock read on each.
+   */
+  class RateLimiter {
+   public:
+    inline static constexpr std::uint64_t kRejectionsPerClockRead = 64;
+
+    FORCE_INLINE bool Allow(std::uint32_t __perSecond) {
+      std::uint64_t count = ++_mCount;
+      if (count <= __perSecond && _mWindowEnd != 0) [[likely]] {
+        return true;
+      }
+      if (count > __perSecond && (count - __perSecond - 1) % kRejectionsPerClockRead != 0) [[likely]] {
+        return false;
+      }
+      return nextWindow(__perSecond);
+    }
+
+   private:
+    NO_INLINE bool nextWindow(std::uint32_t __perSecond) {
+      std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now().time_since_epoch())
+                             .count();
+      if (_mWindowEnd == 0 || now >= _mWindowEnd) {
+        _mWindowEnd = now + kWindowNs;
+        _mCount     = 1;
+      }
+      return _mCount <= __perSecond;
+    }
+
+    inline static constexpr std::int64_t kWindowNs = 1'000'000'000;
+    std::uint64_t                        _mCount{0};
+    std::int64_t                         _mWindowEnd{0};  ///< Steady clock ns; 0 before the first record.
+  };
+
+  /**
+   * @brief Bernoulli sampler on a xorshift32 generator, seeded on first use from its own
+   *        address, so that call sites and threads do not sample the same records.
+   */
+  class Sampler {
+   public:
+    FORCE_INLINE bool Allow(double __probability) {
+      if (_mState == 0) [[unlikely]] {
+        seed();  // xorshift never reaches 0 from another state, so 0 means not seeded yet.
+      }
+      _mState ^= _mState << 13;
+      _mState ^= _mState >> 17;
+      _mState ^= _mState << 5;
+      return _mState <= threshold(__probability);
+    }
+
+   private:
+    static constexpr std::uint32_t threshold(double __probability) {
+      if (__probability >= 1.0) return UINT32_MAX;
+      if (__probability <= 0.0) return 0;
+      return static_cast<std::uint32_t>(__probability * 4294967295.0);
+    }
+
+    NO_INLINE void seed() {
+      // Finaliser of MurmurHash3: neighbouring addresses give unrelated seeds.
+      auto value = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(this));
+      value ^= value >> 33;
+      value *= 0xFF51AFD7ED558CCDULL;
+      value ^= value >> 33;
+      value *= 0xC4CEB9FE1A85EC53ULL;
+      value ^= value >> 33;
+      _mState = static_cast<std::uint32_t>(value ^ (value >> 32));
+      if (_mState == 0) _mState = 0x9E3779B9U;
+    }
+
+    std::uint32_t _mState{0};
+  };
+
+  /**
+   * @brief Lets through the 1st, (N+1)th, (2N+1)th... record.
+   */
+  class EveryN {
+   public:
+    FORCE_INLINE bool Allow(std::uint32_t __n) {
+      if (_mCountdown-- != 0) [[likely]] {
+        return false;
+      }
+      _mCountdown = __n == 0 ? 0 : __n - 1;
+      return true;
+    }
+
+   private:
+    std::uint32_t _mCountdown{0};
+  };
+}  // namespace SNJ
+
+#endif  // CALLSITELIMITER_HPP
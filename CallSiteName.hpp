@@ -0,0 +1,270 @@
+#ifndef CALLSITENAME_HPP
+#define CALLSITENAME_HPP
+
+#include <cstddef>
+#include <string_view>
+
+namespace SNJ {
+
+  /**
+   * @brief Fixed-size character array produced at compile time, N including the terminator.
+   */
+  template <std::size_t N>
+  struct FixedString {
+    char Value[N] = {};
+  };
+
+  namespace CallSiteName {
+    inline constexpr std::size_t npos = std::string_view::npos;
+
+    constexpr bool isIdentifier(char __c) {
+      return (__c >= 'a' && __c <= 'z') || (__c >= 'A' && __c <= 'Z') || (__c >= '0' && __c <= '9') || __c == '_';
+    }
+
+    /**
+     * @brief Position of the bracket opening the group that closes at @p __close, counting
+     *        `()` and `<>` alike; npos if unbalanced.
+     */
+    constexpr std::size_t openingBracket(std::string_view __text, std::size_t __close) {
+      int depth = 0;
+      for (std::size_t i = __close + 1; i-- > 0;) {
+        char c = __text[i];
+        depth += (c == ')' || c == '>') - (c == '(' || c == '<');
+        if (depth == 0) return i;
+      }
+      return npos;
+    }
+
+    /**
+     * @brief Position of `operator` as a whole word in @p __name, npos if none.
+     */
+    constexpr std::size_t operatorKeyword(std::string_view __name) {
+      for (std::size_t at = __name.rfind("operator"); at != npos; at = at ? __name.rfind("operator", at - 1) : npos) {
+        std::size_t after = at + 8;
+        if ((at == 0 || !isIdentifier(__name[at - 1])) && (after == __name.size() || !isIdentifier(__name[after]))) {
+          return at;
+        }
+      }
+      return npos;
+    }
+
+    /**
+     * @brief Length of the qualifiers (` const`, ` volatile`, ` &`, ` &&`) at @p __at, just
+     *        after a parameter list; 0 if there are none.
+     */
+    constexpr std::size_t qualifiersLength(std::string_view __text, std::size_t __at) {
+      constexpr std::string_view kQualifiers[] = {" const", " volatile", " noexcept", " &&", " &"};
+      std::size_t                length        = 0;
+      for (bool found = true; found;) {
+        found                 = false;
+        std::string_view rest = __at + length < __text.size() ? __text.substr(__at + length) : std::string_view{};
+        for (std::string_view qualifier : kQualifiers) {
+          std::size_t after = qualifier.size();
+          bool        whole = qualifier[1] == '&' || after >= rest.size() || !isIdentifier(rest[after]);
+          if (rest.starts_with(qualifier) && whole) {
+            length += after;
+            found   = true;
+            break;
+          }
+        }
+      }
+      return length;
+    }
+
+    /**
+     * @brief If @p __text ends with the group naming a function that returns a pointer or a
+     *        reference, as `(* S::f())` in `void (* S::f())(int)`, narrows it to `S::f()`.
+     * @return whether @p __text was narrowed; a parameter list is left alone.
+     */
+    constexpr bool unwrapDeclarator(std::string_view& __text) {
+      if (__text.empty() || __text.back() != ')') return false;
+      std::size_t open = openingBracket(__text, __text.size() - 1);
+      if (open == npos) return false;
+      std::string_view inner = __text.substr(open + 1, __text.size() - open - 2);
+      std::size_t      space = inner.find(' ');
+      if (space == npos || space == 0 || (inner[space - 1] != '*' && inner[space - 1] != '&') ||
+          inner.substr(0, space).find_first_of("(<") != npos) {
+        return false;
+      }
+      __text = inner.substr(space + 1);
+      return true;
+    }
+
+    /**
+     * @brief Appends @p __text to @p __out at @p __size unless @p __out is null, which only
+     *        measures.
+     */
+    constexpr void append(char* __out, std::size_t& __size, std::string_view __text) {
+      for (char c : __text) {
+        if (__out) __out[__size] = c;
+        ++__size;
+      }
+    }
+
+    /**
+     * @brief Writes `Class::method` for a GCC/Clang __PRETTY_FUNCTION__: return type, parameter
+     *        list, qualifiers, template arguments and outer namespaces are dropped; a lambda
+     *        becomes `function::lambda`.
+     * @return length of the name.
+     */
+    constexpr std::size_t trimFunction(std::string_view __pretty, char* __out) {
+      std::string_view text = __pretty.substr(0, __pretty.find(" [with "));  // GCC template bindings.
+
+      // A function returning a pointer to function or array is named inside a group of its
+      // own, which holds a parameter list in turn: `void (* S::f())(int)`, `int (& S::g())[3]`.
+      while (true) {
+        while (!text.empty() && text.back() == ']') text = text.substr(0, text.rfind('['));
+        if (unwrapDeclarator(text)) continue;
+
+        // Qualifiers after the parameter list: const, volatile, noexcept, & and &&.
+        std::size_t end = text.size();
+        while (end > 0 && (isIdentifier(text[end - 1]) || text[end - 1] == ' ' || text[end - 1] == '&')) --end;
+        if (end > 0 && text[end - 1] == ')') {
+          std::size_t open = openingBracket(text, end - 1);
+          end              = open == npos ? end : open;
+        } else {
+          end = text.size();  // No parameter list, e.g. the body of a lambda.
+        }
+        text = text.substr(0, end);
+        if (!unwrapDeclarator(text)) break;
+      }
+
+      // Operator symbols contain brackets of their own; scan only what precedes them.
+      std::size_t      keyword = operatorKeyword(text);
+      std::string_view scoped  = keyword == npos ? text : text.substr(0, keyword);
+      std::string_view symbol  = keyword == npos ? std::string_view{} : text.substr(keyword);
+
+      // The name starts after the last space outside brackets: what precedes is the return type.
+      // Spaces of the qualifiers of an enclosing function, as in `S::f() const::<lambda()>`, do
+      // not count.
+      std::size_t start = scoped.size();
+      while (start > 0) {
+        char c = scoped[start - 1];
+        if (c == ' ') {
+          std::size_t qualified = start - 1;
+          while (qualified > 0 && (isIdentifier(scoped[qualified - 1]) || scoped[qualified - 1] == ' ' ||
+                                   scoped[qualified - 1] == '&')) {
+            --qualified;
+          }
+          std::size_t length = qualifiersLength(scoped, qualified);
+          if (qualified == 0 || scoped[qualified - 1] != ')' || length == 0 ||
+              !scoped.substr(qualified + length).starts_with("::")) {
+            break;
+          }
+          start = qualified;
+          continue;
+        }
+        if (c == ')' || c == '>') {
+          std::size_t open = openingBracket(scoped, start - 1);
+          if (open == npos) break;
+          start = open;
+        } else {
+          --start;
+        }
+      }
+      scoped = scoped.substr(start);
+
+      // Keep the last two scopes, without their bracket groups.
+      std::size_t scopes   = 0;
+      std::size_t keepFrom = 0;
+      std::size_t previous = 0;
+      for (std::size_t i = 0; i < scoped.size(); ++i) {
+        char c = scoped[i];
+        if (c == '(' || c == '<') {
+          int depth = 0;
+          for (; i < scoped.size(); ++i) {
+            depth += (scoped[i] == '(' || scoped[i] == '<') - (scoped[i] == ')' || scoped[i] == '>');
+            if (depth == 0) break;
+          }
+        } else if (c == ':' && i + 1 < scoped.size() && scoped[i + 1] == ':') {
+          ++scopes;
+          keepFrom = previous;
+          previous = i + 2;
+          ++i;
+        }
+      }
+      if (scopes < 2) keepFrom = 0;
+
+      std::size_t size = 0;
+      for (std::size_t i = keepFrom; i < scoped.size(); ++i) {
+        char c = scoped[i];
+        if (c != '(' && c != '<') {
+          if (__out) __out[size] = c;
+          ++size;
+          continue;
+        }
+        if (scoped.substr(i, 7) == "<lambda") append(__out, size, "lambda");
+        int depth = 0;
+        for (; i < scoped.size(); ++i) {
+          depth += (scoped[i] == '(' || scoped[i] == '<') - (scoped[i] == ')' || scoped[i] == '>');
+          if (depth == 0) break;
+        }
+        if (i < scoped.size() && scoped[i] == ')') i += qualifiersLength(scoped, i + 1);
+      }
+      append(__out, size, symbol);
+      return size;
+    }
+
+    /// Whether trimFunction() turns @p __pretty into @p __expected; for the checks below.
+    constexpr bool trimsTo(std::string_view __pretty, std::string_view __expected) {
+      char name[64] = {};
+      return trimFunction(__pretty, nullptr) < sizeof(name) &&
+             std::string_view(name, trimFunction(__pretty, name)) == __expected;
+    }
+
+    static_assert(trimsTo("void ns::S::f(int) const", "S::f"));
+    static_assert(trimsTo("bool ns::S::operator()(int) &&", "S::operator()"));
+    static_assert(trimsTo("ns::S::c() const::<lambda()>", "c::lambda"));
+    static_assert(trimsTo("ns::S::r() const &::<lambda(int)>", "r::lambda"));
+    static_assert(trimsTo("S::c() const::<lambda()>::<lambda()>", "lambda::lambda"));
+    static_assert(trimsTo("static void (* ns::S::fp())(int)", "S::fp"));
+    static_assert(trimsTo("int (& ns::S::ar() const)[3]", "S::ar"));
+    static_assert(trimsTo("void (ns::S::* ns::S::mp())()", "S::mp"));
+
+    constexpr std::string_view baseName(std::string_view __path) { return __path.substr(__path.rfind('/') + 1); }
+
+    /**
+     * @brief Writes `Class::method@file.cpp:line`, or only measures if @p __out is null.
+     */
+    constexpr std::size_t build(std::string_view __pretty, std::string_view __file, std::string_view __line,
+                                char* __out) {
+      std::size_t size = trimFunction(__pretty, __out);
+      append(__out, size, "@");
+      append(__out, size, baseName(__file));
+      append(__out, size, ":");
+      append(__out, size, __line);
+      return size;
+    }
+  }  // namespace CallSiteName
+
+  /// Length of the call-site name MakeCallSiteName() produces for these arguments.
+  constexpr std::size_t CallSiteNameLength(std::string_view __pretty, std::string_view __file,
+                                           std::string_view __line) {
+    return CallSiteName::build(__pretty, __file, __line, nullptr);
+  }
+
+  /**
+   * @brief Compact call-site name for SNJ_CALL_SITE, computed at compile time so that neither
+   *        the full __PRETTY_FUNCTION__ nor the full __FILE__ reaches the binary.
+   */
+  template <std::size_t Length>
+  constexpr FixedString<Length + 1> MakeCallSiteName(std::string_view __pretty, std::string_view __file,
+                                                     std::string_view __line) {
+    FixedString<Length + 1> name;
+    CallSiteName::build(__pretty, __file, __line, name.Value);
+    return name;
+  }
+}  // namespace SNJ
+
+#define SNJ_STRINGIZE_IMPL(x) #x
+#define SNJ_STRINGIZE(x) SNJ_STRINGIZE_IMPL(x)
+
+/**
+ * `Class::method@file.cpp:line` of the statement expanding it, as a character array constant.
+ */
+#define SNJ_CALL_SITE()                                                                                       \
+  SNJ::MakeCallSiteName<SNJ::CallSiteNameLength(__PRETTY_FUNCTION__, __FILE__, SNJ_STRINGIZE(__LINE__))>( \
+      __PRETTY_FUNCTION__, __FILE__, SNJ_STRINGIZE(__LINE__))                                                 \
+      .Value
+
+#endif  // CALLSITENAME_HPP
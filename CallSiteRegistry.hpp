@@ -0,0 +1,189 @@
+#ifndef CALLSITEREGISTRY_HPP
+#define CALLSITEREGISTRY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "LogLevel.hpp"
+#include "NonCopyMovable.hpp"
+
+namespace SNJ {
+
+  /// Call site threshold meaning "use the logger's level".
+  inline static constexpr std::uint8_t kInheritLogLevel = 0xFF;
+
+  /**
+   * @brief Runtime state of one log statement, embedded in its formatter.
+   *
+   * `_mThreshold` is the only field read on the hot path: one relaxed byte load, written only
+   * when the configuration changes.
+   */
+  struct CallSite {
+    constexpr CallSite(std::string_view __text, std::string_view __category) : _mText(__text), _mCategory(__category) {}
+
+    std::atomic<std::uint8_t> _mThreshold{kInheritLogLevel};  ///< Minimum LogLevel, or kInheritLogLevel.
+    std::string_view          _mText;                         ///< `site:format` of the statement.
+    std::string_view          _mCategory;                     ///< Empty if the macro declared none.
+    std::int16_t              _mOverride{-1};                 ///< Level set for this site itself; registry lock.
+    CallSite*                 _mNext{nullptr};                ///< Registry list; registry lock.
+  };
+
+  /**
+   * @class CallSiteRegistry
+   * @brief Every log statement of the program, registered at static-initialisation time, with
+   *        runtime level overrides per call site and per category.
+   *
+   * A site override wins over its category's, which wins over the logger level. Rules are kept
+   * and applied to sites that register later, e.g. from a library loaded at runtime.
+   */
+  class CallSiteRegistry {
+   public:
+    /// (site pattern or category, level) pairs; later entries win.
+    using Rules = std::vector<std::pair<std::string, LogLevel>>;
+
+    static void Register(CallSite& __site) {
+      std::lock_guard<std::mutex> lock(mutex());
+      __site._mNext = sHead;
+      sHead         = &__site;
+      applySiteRules(__site);
+      refresh(__site);
+    }
+
+    /**
+     * @brief Sets the minimum level of every statement declared with @p __category.
+     */
+    static void SetCategoryLevel(std::string_view __category, LogLevel __logLevel) {
+      std::lock_guard<std::mutex> lock(mutex());
+      setRule(categoryRules(), __category, __logLevel);
+      refreshAll();
+    }
+
+    static void ClearCategoryLevel(std::string_view __category) {
+      std::lock_guard<std::mutex> lock(mutex());
+      eraseRule(categoryRules(), __category);
+      refreshAll();
+    }
+
+    /**
+     * @brief Sets the minimum level of every statement whose `site:format` text contains
+     *        @p __pattern, e.g. a function name or a format string.
+     * @return number of matching call sites registered so far.
+     */
+    static std::size_t SetSiteLevel(std::string_view __pattern, LogLevel __logLevel) {
+      std::lock_guard<std::mutex> lock(mutex());
+      setRule(siteRules(), __pattern, __logLevel);
+      std::size_t matched = 0;
+      for (CallSite* site = sHead; site; site = site->_mNext) {
+        if (site->_mText.find(__pattern) == std::string_view::npos) continue;
+        site->_mOverride = static_cast<std::int16_t>(__logLevel);
+        refresh(*site);
+        ++matched;
+      }
+      return matched;
+    }
+
+    /**
+     * @brief Drops all site and category overrides; every statement follows its logger again.
+     */
+    static void ClearOverrides() {
+      std::lock_guard<std::mutex> lock(mutex());
+      siteRules().clear();
+      categoryRules().clear();
+      for (CallSite* site = sHead; site; site = site->_mNext) {
+        site->_mOverride = -1;
+      }
+      refreshAll();
+    }
+
+    /**
+     * @brief Replaces every site and category rule in one step: each call site goes straight
+     *        from its old threshold to its new one, never through an intermediate state.
+     */
+    static void ReplaceOverrides(Rules __siteRules, Rules __categoryRules) {
+      std::lock_guard<std::mutex> lock(mutex());
+      siteRules()     = std::move(__siteRules);
+      categoryRules() = std::move(__categoryRules);
+      for (CallSite* site = sHead; site; site = site->_mNext) {
+        applySiteRules(*site);
+        refresh(*site);
+      }
+    }
+
+    template <class TCallback>
+    static void ForEach(TCallback __callback) {
+      std::lock_guard<std::mutex> lock(mutex());
+      for (CallSite* site = sHead; site; site = site->_mNext) {
+        __callback(static_cast<const CallSite&>(*site));
+      }
+    }
+
+   private:
+    static std::mutex& mutex() {
+      static std::mutex sMutex;
+      return sMutex;
+    }
+
+    // Function statics: registration runs during static initialisation of other objects.
+    static Rules& siteRules() {
+      static Rules sRules;
+      return sRules;
+    }
+
+    static Rules& categoryRules() {
+      static Rules sRules;
+      return sRules;
+    }
+
+    static void setRule(Rules& __rules, std::string_view __key, LogLevel __logLevel) {
+      eraseRule(__rules, __key);
+      __rules.emplace_back(std::string(__key), __logLevel);
+    }
+
+    static void eraseRule(Rules& __rules, std::string_view __key) {
+      std::erase_if(__rules, [__key](const auto& __rule) { return __rule.first == __key; });
+    }
+
+    static void applySiteRules(CallSite& __site) {
+      __site._mOverride = -1;
+      for (const auto& rule : siteRules()) {
+        if (__site._mText.find(rule.first) != std::string_view::npos) {
+          __site._mOverride = static_cast<std::int16_t>(rule.second);
+        }
+      }
+    }
+
+    static void refresh(CallSite& __site) {
+      std::uint8_t threshold = kInheritLogLevel;
+      if (__site._mOverride >= 0) {
+        threshold = static_cast<std::uint8_t>(__site._mOverride);
+      } else if (!__site._mCategory.empty()) {
+        for (const auto& rule : categoryRules()) {
+          if (rule.first == __site._mCategory) threshold = static_cast<std::uint8_t>(rule.second);
+        }
+      }
+      __site._mThreshold.store(threshold, std::memory_order_relaxed);
+    }
+
+    static void refreshAll() {
+      for (CallSite* site = sHead; site; site = site->_mNext) {
+        refresh(*site);
+      }
+    }
+
+    inline static CallSite* sHead = nullptr;
+  };
+
+  /**
+   * @brief Static member of each formatter whose construction registers its call site.
+   */
+  struct CallSiteRegistrar {
+    explicit CallSiteRegistrar(CallSite& __site) { CallSiteRegistry::Register(__site); }
+    MAKE_NON_COPYABLE(CallSiteRegistrar);
+  };
+}  // namespace SNJ
+
+#endif  // CALLSITEREGISTRY_HPP
@@ -0,0 +1,157 @@
+#ifndef CRASHHANDLER_HPP
+#define CRASHHANDLER_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <ctime>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "FastLogger.hpp"
+#include "NonCopyMovable.hpp"
+#include "SignalSafeWriter.hpp"
+
+namespace SNJ {
+
+  struct CrashHandlerOptions {
+    bool _mAbortOnFatal{false};  ///< Call abort() after a LOG_FATAL has been flushed.
+  };
+
+  /**
+   * @class CrashHandler
+   * @brief Opt-in flush of every logger's thread queues on SIGSEGV, SIGBUS, SIGABRT and LOG_FATAL.
+   *
+   * On a signal, records still queued are rendered with SignalSafeWriter and appended to each
+   * logger's live file (stderr if it has none) using open/write only, then the previous
+   * disposition is restored and the signal re-raised. On LOG_FATAL the producer thread runs a
+   * regular synchronous consumer pass over all loggers instead, since it is not in a signal
+   * context.
+   *
+   * A stack overflow can only be handled on an alternate signal stack, which is per thread:
+   * the thread calling Install() gets one, and so does every thread when it first logs after
+   * that. Threads that logged before Install() and never log again do not.
+   */
+  class CrashHandler {
+   public:
+    static void Install(CrashHandlerOptions __options = {}) {
+      if (sInstalled.exchange(true)) return;
+      sOptions = __options;
+
+      setUpThread();
+      gThreadQueueHook.store(&setUpThread, std::memory_order_release);
+
+      struct sigaction action{};
+      action.sa_handler = &handleSignal;
+      action.sa_flags   = SA_ONSTACK;
+      sigemptyset(&action.sa_mask);
+      for (std::size_t i = 0; i < kSignalCount; ++i) {
+        sigaction(kSignals[i], &action, &sPreviousActions[i]);
+      }
+
+      gFatalHook.store(&onFatal, std::memory_order_release);
+    }
+
+    static bool IsInstalled() { return sInstalled.load(std::memory_order_relaxed); }
+
+   private:
+    /**
+     * @brief Alternate stack of one thread, so that a stack overflow SIGSEGV can still be
+     *        handled there. Left alone if the thread already has one.
+     */
+    class AlternateStack {
+     public:
+      inline static constexpr std::size_t kSize = 64 * 1024;
+
+      AlternateStack() {
+        stack_t current{};
+        if (sigaltstack(nullptr, &current) != 0 || !(current.ss_flags & SS_DISABLE)) return;
+        stack_t stack{};
+        stack.ss_sp    = std::malloc(kSize);
+        stack.ss_size  = kSize;
+        stack.ss_flags = 0;
+        if (stack.ss_sp && sigaltstack(&stack, nullptr) == 0) {
+          _mMemory = stack.ss_sp;
+        } else {
+          std::free(stack.ss_sp);
+        }
+      }
+
+      ~AlternateStack() {
+        if (!_mMemory) return;
+        stack_t disable{};
+        disable.ss_flags = SS_DISABLE;
+        sigaltstack(&disable, nullptr);
+        std::free(_mMemory);
+      }
+
+      MAKE_NON_COPYABLE(AlternateStack);
+      MAKE_NON_MOVABLE(AlternateStack);
+
+     private:
+      void* _mMemory{nullptr};
+    };
+
+    static void setUpThread() { thread_local AlternateStack sStack; }
+
+    inline static constexpr int         kSignals[]   = {SIGSEGV, SIGBUS, SIGABRT};
+    inline static constexpr std::size_t kSignalCount = sizeof(kSignals) / sizeof(kSignals[0]);
+
+    static void handleSignal(int __signal) {
+      int savedErrno = errno;
+      if (!sCrashing.exchange(true)) {
+        drainAll(__signal);
+      }
+
+      for (std::size_t i = 0; i < kSignalCount; ++i) {
+        if (kSignals[i] == __signal) {
+          sigaction(__signal, &sPreviousActions[i], nullptr);
+        }
+      }
+      errno = savedErrno;
+      raise(__signal);
+    }
+
+    static void drainAll(int __signal) {
+      struct timespec now{};
+      clock_gettime(CLOCK_REALTIME, &now);
+
+      FastLogger::ForEachLoggerSignalSafe([&](FastLogger& __logger) {
+        const char* path = __logger.GetSignalSafeFilePath();
+        int         fd   = path ? open(path, O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644) : -1;
+        int         out  = fd >= 0 ? fd : STDERR_FILENO;
+        {
+          SignalSafeWriter writer(out);
+          writer.Append("[CRASH] signal ");
+          writer.AppendSigned(__signal);
+          writer.Append(" at ");
+          writer.AppendUtcTime(now.tv_sec);
+          writer.Append(" UTC, flushing queued records\n");
+        }
+        __logger.DrainSignalSafe(out);
+        if (fd >= 0) {
+          fsync(fd);
+          close(fd);
+        }
+      });
+    }
+
+    static void onFatal() {
+      if (sCrashing.load(std::memory_order_relaxed)) return;
+      FastLogger::ForEachLoggerSignalSafe([](FastLogger& __logger) { __logger.ConsumeAndWriteLogs(); });
+      if (sOptions._mAbortOnFatal) {
+        std::abort();
+      }
+    }
+
+    inline static std::atomic<bool>   sInstalled{false};
+    inline static std::atomic<bool>   sCrashing{false};
+    inline static CrashHandlerOptions sOptions;
+    inline static struct sigaction    sPreviousActions[kSignalCount];
+  };
+}  // namespace SNJ
+
+#endif  // CRASHHANDLER_HPP
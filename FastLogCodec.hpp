@@ -0,0 +1,421 @@
+#ifndef FASTLOGCODEC_HPP
+#define FASTLOGCODEC_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/// Elements of a container argument copied into a record; the rest are shown as `...`.
+#ifndef SNJ_FASTLOGGER_MAX_CONTAINER_ELEMENTS
+#define SNJ_FASTLOGGER_MAX_CONTAINER_ELEMENTS 32
+#endif
+
+namespace SNJ {
+
+  /**
+   * @brief How an argument of type T travels through the queue: the producer encodes it into
+   *        the record, the consumer renders it when the record is written.
+   *
+   * Specialise it for types the defaults do not cover, with:
+   * @code
+   *   static std::size_t EncodedSize(const T& __value);                        // bytes Encode() writes
+   *   static char*       Encode(char* __buffer, const T& __value);             // returns the end
+   *   static const char* Render(const char* __data, std::ostream& __stream);  // returns the end
+   * @endcode
+   * and, if every encoding has the same size, `static constexpr std::size_t kFixedSize`. An
+   * encoding holding addresses into the executable, or one of variable size that arguments
+   * holding such addresses may follow, also needs
+   * `static char* Rebase(char* __data, std::ptrdiff_t __delta)`, see RebaseArgument().
+   * Trivially copyable types default to MemcpyCodec, rendered with operator<<; arrays,
+   * std::array, std::vector and std::span of encodable elements to SequenceCodec. A struct that
+   * has no operator<< can keep the memcpy and only supply the rendering:
+   * @code
+   *   template <>
+   *   struct SNJ::FastLogCodec<Order> : SNJ::MemcpyCodec<Order> {
+   *     static const char* Render(const char* __data, std::ostream& __stream) {
+   *       Order order = Decode(__data);
+   *       __stream << order.id << ' ' << order.qty << '@' << order.px;
+   *       return __data + sizeof(Order);
+   *     }
+   *   };
+   * @endcode
+   * Render() runs on the consumer, possibly after the producer's objects are gone: encodings
+   * must not refer to producer memory that may have changed or been freed by then.
+   */
+  template <class T, class Enable = void>
+  struct FastLogCodec {
+    static_assert(std::is_trivially_copyable_v<T>,
+                  "argument type is not trivially copyable; specialise SNJ::FastLogCodec for it");
+  };
+
+  /**
+   * @brief Stores the object representation of a trivially copyable T.
+   */
+  template <class T>
+  struct MemcpyCodec {
+    static_assert(std::is_trivially_copyable_v<T>);
+
+    static constexpr std::size_t kFixedSize = sizeof(T);
+
+    static constexpr std::size_t EncodedSize(const T&) { return sizeof(T); }
+
+    static char* Encode(char* __buffer, const T& __value) {
+      memcpy(__buffer, &__value, sizeof(T));
+      return __buffer + sizeof(T);
+    }
+
+    /// Copy of the encoded value; the record buffer is not aligned for T.
+    static T Decode(const char* __data) {
+      struct Bytes {
+        char _mValue[sizeof(T)];
+      } bytes;
+      memcpy(bytes._mValue, __data, sizeof(T));
+      return std::bit_cast<T>(bytes);
+    }
+
+    static const char* Render(const char* __data, std::ostream& __stream) {
+      __stream << Decode(__data);
+      return __data + sizeof(T);
+    }
+  };
+
+  /**
+   * @brief Moves the addresses in one encoded T by @p __delta, for records written by another
+   *        run of the executable that was loaded elsewhere.
+   * @return end of the argument, or nullptr if it cannot be located without rendering it.
+   */
+  template <class T>
+  char* RebaseArgument(char* __data, std::ptrdiff_t __delta) {
+    using Codec = FastLogCodec<T>;
+    if constexpr (requires { Codec::Rebase(__data, __delta); }) {
+      return Codec::Rebase(__data, __delta);
+    } else if constexpr (requires { Codec::kFixedSize; }) {
+      return __data + Codec::kFixedSize;
+    } else if constexpr (requires(const char*& __end) { Codec::View(__end); }) {
+      const char* end = __data;
+      Codec::View(end);
+      return __data + (end - __data);
+    } else {
+      return nullptr;
+    }
+  }
+
+  /**
+   * @brief Contiguous containers logged element by element; Element is what they hold.
+   */
+  template <class T>
+  struct SequenceTraits : std::false_type {};
+
+  template <class E, std::size_t N>
+  requires(!std::is_same_v<std::remove_cv_t<E>, char>)  // Strings.
+  struct SequenceTraits<E[N]> : std::true_type {
+    using Element = E;
+  };
+
+  template <class E, std::size_t N>
+  struct SequenceTraits<std::array<E, N>> : std::true_type {
+    using Element = E;
+  };
+
+  template <class E, class Allocator>
+  requires(!std::is_same_v<E, bool>)  // Not contiguous.
+  struct SequenceTraits<std::vector<E, Allocator>> : std::true_type {
+    using Element = E;
+  };
+
+  template <class E, std::size_t Extent>
+  struct SequenceTraits<std::span<E, Extent>> : std::true_type {
+    using Element = E;
+  };
+
+  /// Types that default to MemcpyCodec.
+  template <class T>
+  inline constexpr bool kIsMemcpyArgument =
+      std::is_trivially_copyable_v<T> && !std::is_array_v<T> && !SequenceTraits<T>::value;
+
+  template <class T>
+  struct FastLogCodec<T, std::enable_if_t<kIsMemcpyArgument<T>>> : MemcpyCodec<T> {};
+
+  /**
+   * @brief Stores the number of elements captured and the size of the container, then the
+   *        first SNJ_FASTLOGGER_MAX_CONTAINER_ELEMENTS elements: in one memcpy if their codec
+   *        is MemcpyCodec, one by one otherwise. Rendered as `[a, b, c]`, or `[a, b, c...]` if
+   *        elements were left out.
+   */
+  template <class T>
+  struct SequenceCodec {
+    using Element      = std::remove_cv_t<typename SequenceTraits<T>::Element>;
+    using ElementCodec = FastLogCodec<Element>;
+
+    inline static constexpr std::size_t kMaxElements = SNJ_FASTLOGGER_MAX_CONTAINER_ELEMENTS;
+    inline static constexpr bool        kMemcpy      = std::is_base_of_v<MemcpyCodec<Element>, ElementCodec>;
+
+    static std::size_t EncodedSize(const T& __value) {
+      std::size_t count = captured(__value);
+      if constexpr (kMemcpy) {
+        return kHeaderSize + count * sizeof(Element);
+      } else {
+        std::size_t size = kHeaderSize;
+        for (std::size_t i = 0; i < count; ++i) {
+          size += ElementCodec::EncodedSize(std::data(__value)[i]);
+        }
+        return size;
+      }
+    }
+
+    static char* Encode(char* __buffer, const T& __value) {
+      auto count = static_cast<std::uint32_t>(captured(__value));
+      auto total = static_cast<std::uint32_t>(std::min<std::size_t>(std::size(__value), UINT32_MAX));
+      __buffer   = MemcpyCodec<std::uint32_t>::Encode(__buffer, count);
+      __buffer   = MemcpyCodec<std::uint32_t>::Encode(__buffer, total);
+      if constexpr (kMemcpy) {
+        if (count != 0) memcpy(__buffer, std::data(__value), count * sizeof(Element));
+        return __buffer + count * sizeof(Element);
+      } else {
+        for (std::uint32_t i = 0; i < count; ++i) {
+          __buffer = ElementCodec::Encode(__buffer, std::data(__value)[i]);
+        }
+        return __buffer;
+      }
+    }
+
+    static const char* Render(const char* __data, std::ostream& __stream) {
+      std::uint32_t count = MemcpyCodec<std::uint32_t>::Decode(__data);
+      std::uint32_t total = MemcpyCodec<std::uint32_t>::Decode(__data + sizeof(std::uint32_t));
+      __data += kHeaderSize;
+      __stream << '[';
+      for (std::uint32_t i = 0; i < count; ++i) {
+        if (i != 0) __stream << ", ";
+        __data = ElementCodec::Render(__data, __stream);
+      }
+      if (count < total) __stream << "...";
+      __stream << ']';
+      return __data;
+    }
+
+    static char* Rebase(char* __data, std::ptrdiff_t __delta) {
+      std::uint32_t count = MemcpyCodec<std::uint32_t>::Decode(__data);
+      __data += kHeaderSize;
+      if constexpr (kMemcpy) {
+        return __data + count * sizeof(Element);
+      } else {
+        for (std::uint32_t i = 0; i < count && __data; ++i) {
+          __data = RebaseArgument<Element>(__data, __delta);
+        }
+        return __data;
+      }
+    }
+
+   private:
+    inline static constexpr std::size_t kHeaderSize = 2 * sizeof(std::uint32_t);
+
+    static std::size_t captured(const T& __value) { return std::min(std::size(__value), kMaxElements); }
+  };
+
+  template <class T>
+  struct FastLogCodec<T, std::enable_if_t<SequenceTraits<T>::value>> : SequenceCodec<T> {};
+
+  /**
+   * @brief Copies the characters of a string after their length, so that the consumer can
+   *        hand them on as a span without looking for a terminator.
+   */
+  struct StringCodec {
+    using Length = std::uint16_t;  ///< Records are far smaller; longer strings make them oversized.
+
+    static std::size_t EncodedSize(std::string_view __value) { return sizeof(Length) + __value.size(); }
+
+    static char* Encode(char* __buffer, std::string_view __value) {
+      __buffer = MemcpyCodec<Length>::Encode(__buffer, static_cast<Length>(__value.size()));
+      memcpy(__buffer, __value.data(), __value.size());
+      return __buffer + __value.size();
+    }
+
+    /// The encoded characters, in place; @p __data is moved past them.
+    static std::string_view View(const char*& __data) {
+      std::string_view text(__data + sizeof(Length), MemcpyCodec<Length>::Decode(__data));
+      __data = text.data() + text.size();
+      return text;
+    }
+
+    static const char* Render(const char* __data, std::ostream& __stream) {
+      std::string_view text = View(__data);
+      __stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+      return __data;
+    }
+  };
+
+  template <>
+  struct FastLogCodec<std::string> : StringCodec {};
+
+  template <>
+  struct FastLogCodec<std::string_view> : StringCodec {};
+
+  template <>
+  struct FastLogCodec<const char*> : StringCodec {};
+
+  template <>
+  struct FastLogCodec<char*> : StringCodec {};
+
+  /**
+   * @brief A character array holds a string up to its first NUL, or fills the whole array.
+   */
+  template <std::size_t N>
+  struct FastLogCodec<char[N]> : StringCodec {
+    static std::size_t EncodedSize(const char (&__value)[N]) { return StringCodec::EncodedSize(view(__value)); }
+
+    static char* Encode(char* __buffer, const char (&__value)[N]) {
+      return StringCodec::Encode(__buffer, view(__value));
+    }
+
+   private:
+    static std::string_view view(const char (&__value)[N]) { return {__value, strnlen(__value, N)}; }
+  };
+
+  /**
+   * @class StaticStr
+   * @brief A string whose characters outlive every record referring to them, such as a literal
+   *        or a static table of symbol names. Records carry only its address and length; the
+   *        consumer reads the characters when it renders the record.
+   *
+   * Only arguments passed as StaticStr are logged by address: character arrays, literals
+   * included, are copied like any other string, since a `const char[N]` may as well be a member
+   * of an object that is gone by the time the record is rendered. Defining
+   * SNJ_FASTLOGGER_CONST_CHAR_ARRAYS_BY_ADDRESS logs every `const char[N]` argument as StaticStr,
+   * for programs that only pass literals and static tables that way. Records recovered from
+   * persistent queues are rebased onto the new load address of the executable; strings of
+   * shared libraries are not, as with formatters. Once a logging daemon is started, StaticStr
+   * arguments are copied too, since it only sees memory as it was at fork time.
+   */
+  class StaticStr {
+   public:
+    /// Up to the first NUL, or the whole array.
+    template <std::size_t N>
+    constexpr StaticStr(const char (&__value)[N])
+        : _mData(__value), _mSize(static_cast<std::size_t>(std::find(__value, __value + N, '\0') - __value)) {}
+
+    /// @p __value must stay valid and unchanged until every record logging it is written.
+    constexpr explicit StaticStr(std::string_view __value) : _mData(__value.data()), _mSize(__value.size()) {}
+
+    constexpr std::string_view View() const { return {_mData, _mSize}; }
+
+   private:
+    const char* _mData;
+    std::size_t _mSize;
+  };
+
+  /**
+   * @brief Stores the length of a StaticStr, then its address, or its characters while
+   *        CopyCharacters() is on: the consumer cannot read producer memory then, e.g. when a
+   *        logging daemon renders from its copy of the address space taken at fork time. The
+   *        top bit of the length tells which follows.
+   */
+  template <>
+  struct FastLogCodec<StaticStr> {
+    using Address = MemcpyCodec<std::uintptr_t>;
+    using Length  = StringCodec::Length;
+
+    inline static constexpr Length kInline    = 0x8000;  ///< Length flag: the characters follow.
+    inline static constexpr Length kMaxLength = kInline - 1;
+
+    /// Makes every StaticStr encoded from now on carry its characters.
+    static void CopyCharacters(bool __copy) { sCopy.store(__copy, std::memory_order_relaxed); }
+
+    static std::size_t EncodedSize(const StaticStr& __value) {
+      return sizeof(Length) + (copying() ? length(__value) : sizeof(std::uintptr_t));
+    }
+
+    static char* Encode(char* __buffer, const StaticStr& __value) {
+      std::string_view text = __value.View();
+      Length           size = length(__value);
+      if (copying()) {
+        __buffer = MemcpyCodec<Length>::Encode(__buffer, static_cast<Length>(size | kInline));
+        memcpy(__buffer, text.data(), size);
+        return __buffer + size;
+      }
+      __buffer = MemcpyCodec<Length>::Encode(__buffer, size);
+      return Address::Encode(__buffer, reinterpret_cast<std::uintptr_t>(text.data()));
+    }
+
+    /// The characters, in the record or where the producer left them; @p __data is moved past.
+    static std::string_view View(const char*& __data) {
+      Length header = MemcpyCodec<Length>::Decode(__data);
+      __data += sizeof(Length);
+      std::string_view text(__data, header & kMaxLength);
+      if (header & kInline) {
+        __data += text.size();
+      } else {
+        text = {reinterpret_cast<const char*>(Address::Decode(__data)), text.size()};
+        __data += sizeof(std::uintptr_t);
+      }
+      return text;
+    }
+
+    static const char* Render(const char* __data, std::ostream& __stream) {
+      std::string_view text = View(__data);
+      __stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+      return __data;
+    }
+
+    static char* Rebase(char* __data, std::ptrdiff_t __delta) {
+      Length header = MemcpyCodec<Length>::Decode(__data);
+      __data += sizeof(Length);
+      if (header & kInline) return __data + (header & kMaxLength);
+      Address::Encode(__data, Address::Decode(__data) + static_cast<std::uintptr_t>(__delta));
+      return __data + sizeof(std::uintptr_t);
+    }
+
+   private:
+    static bool copying() { return sCopy.load(std::memory_order_relaxed); }
+
+    static Length length(const StaticStr& __value) {
+      return static_cast<Length>(std::min<std::size_t>(__value.View().size(), kMaxLength));
+    }
+
+    inline static std::atomic<bool> sCopy{false};
+  };
+
+  /// Arguments logged as StaticStr when passed as they are.
+#if defined(SNJ_FASTLOGGER_CONST_CHAR_ARRAYS_BY_ADDRESS)
+  template <class T>
+  inline constexpr bool kIsStaticStrArgument =
+      std::is_same_v<std::remove_cv_t<T>, StaticStr> ||
+      (std::is_array_v<T> && std::is_same_v<std::remove_extent_t<T>, const char>);
+#else
+  template <class T>
+  inline constexpr bool kIsStaticStrArgument = std::is_same_v<std::remove_cv_t<T>, StaticStr>;
+#endif
+
+  /**
+   * @brief Type an argument is encoded as: see kIsStaticStrArgument; otherwise references and
+   *        cv-qualifiers are dropped, arrays are kept as arrays, anything else decays.
+   */
+  template <class T, class U = std::remove_reference_t<T>>
+  using ArgumentType =
+      std::conditional_t<kIsStaticStrArgument<U>, StaticStr,
+                         std::conditional_t<std::is_array_v<U>, std::remove_cv_t<U>, std::decay_t<T>>>;
+
+  template <class T>
+  using ArgumentCodec = FastLogCodec<ArgumentType<T>>;
+
+  /**
+   * @brief Strings are the only non-arithmetic encodings the consumer understands without
+   *        their codec, e.g. when rendering from a signal handler: their codec has View().
+   */
+  template <class T>
+  inline constexpr bool kIsStringArgument = requires(const char*& __data) {
+    { FastLogCodec<T>::View(__data) } -> std::same_as<std::string_view>;
+  };
+}  // namespace SNJ
+
+#endif  // FASTLOGCODEC_HPP
@@ -5,70 +5,140 @@
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include <ctime>
 #include <fstream>
 #include <iomanip>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "CallSiteLimiter.hpp"
+#include "CallSiteName.hpp"
+#include "FastLogCodec.hpp"
+#include "CallSiteRegistry.hpp"
+#include "FlightRecorder.hpp"
+#include "LogLevel.hpp"
+#include "LogSink.hpp"
+#include "LogStats.hpp"
 #include "NonCopyMovable.hpp"
+#include "PersistentQueue.hpp"
+#include "RotatingLogFile.hpp"
 #include "SPSCQueue.hpp"
+#include "SharedQueueRegistry.hpp"
+#include "SignalSafeWriter.hpp"
+#include "StringInterner.hpp"
+#include "StructuredWriter.hpp"
 
 namespace SNJ {
 
-  enum class LogLevel : std::uint8_t {
-    DEBUG,  ///< Debug-level messages.
-    INFO,   ///< Informational messages.
-    ERROR,  ///< Error-level messages.
-    FATAL   ///< Fatal-level messages.
-  };
-
-  inline static std::string LogLevelToString(LogLevel __logLevel) {
-    switch (__logLevel) {
-      case LogLevel::DEBUG:
-        return "DEBUG";
-      case LogLevel::INFO:
-        return "INFO";
-      case LogLevel::ERROR:
-        return "ERROR";
-      case LogLevel::FATAL:
-        return "FATAL";
-    }
-    return "INVALID";
-  }
-
-  inline static LogLevel LogLevelStrToEnum(const std::string &logLevelStr) {
-    static const std::unordered_map<std::string, LogLevel> logLevelMap = {
-        {"DEBUG", LogLevel::DEBUG},
-        {"INFO", LogLevel::INFO},
-        {"ERROR", LogLevel::ERROR},
-        {"FATAL", LogLevel::FATAL}
-    };
-
-    auto it = logLevelMap.find(logLevelStr);
-    return (it != logLevelMap.end()) ? it->second : LogLevel::FATAL;
-}
-
-  
   class BaseLogFormatter {
    protected:
-    constexpr BaseLogFormatter(std::string_view __formatString) : _mFormatString(__formatString) {}
+    constexpr BaseLogFormatter(std::string_view __formatString, std::size_t __siteLength = 0,
+                               std::string_view __category = {})
+        : _mFormatString(__formatString), _mSiteLength(__siteLength), _mCallSite(__formatString, __category) {}
     virtual ~BaseLogFormatter() noexcept = default;
 
     std::string_view _mFormatString;
+    std::size_t      _mSiteLength;  ///< Length of the call-site prefix, excluding its ':' separator.
+    CallSite         _mCallSite;
 
    public:
     virtual void Evaluate(const char* __data, std::ostringstream& __stream) const = 0;
+
+    /**
+     * @brief Writes the record as structured fields. By default the rendered text without the
+     *        call-site prefix becomes the "msg" field.
+     * @param __scratch consumer-owned stream that may be used as a temporary.
+     */
+    virtual void EvaluateFields(const char* __data, StructuredWriter& __writer, std::ostringstream& __scratch) const {
+      __scratch.str({});
+      Evaluate(__data, __scratch);
+      std::string_view text = __scratch.view();
+      text.remove_prefix(std::min(text.size(), _mSiteLength + 1));
+      __writer.Field("msg", text);
+    }
+
+    /**
+     * @brief Renders the record using only async-signal-safe operations, for crash dumps.
+     *        The default writes the format string with its placeholders untouched.
+     */
+    virtual void EvaluateSignalSafe(const char*, SignalSafeWriter& __writer) const { __writer.Append(_mFormatString); }
+
+    /**
+     * @brief Moves the addresses held by the arguments by @p __delta, for records recovered from
+     *        a run of the executable loaded elsewhere. The default assumes there are none.
+     */
+    virtual void Rebase(char*, std::ptrdiff_t) const {}
+
+    std::string_view GetSite() const { return _mFormatString.substr(0, _mSiteLength); }
+
+    /// `site:format` text identifying the statement.
+    std::string_view GetText() const { return _mFormatString; }
+
+    CallSite& GetCallSite() { return _mCallSite; }
+  };
+
+  /**
+   * @class FormatterRegistry
+   * @brief Every formatter of the program, registered at static-initialisation time, so that
+   *        a formatter address read from outside, e.g. from a persistent queue, can be checked
+   *        before anything is called through it.
+   */
+  class FormatterRegistry {
+   public:
+    static void Register(const BaseLogFormatter& __formatter) {
+      std::lock_guard<std::mutex> lock(mutex());
+      formatters().insert(&__formatter);
+    }
+
+    static bool Contains(const BaseLogFormatter* __formatter) {
+      std::lock_guard<std::mutex> lock(mutex());
+      return formatters().contains(__formatter);
+    }
+
+   private:
+    static std::mutex& mutex() {
+      static std::mutex sMutex;
+      return sMutex;
+    }
+
+    // Intentionally leaked: formatters of libraries may register and be looked up during exit.
+    static std::unordered_set<const BaseLogFormatter*>& formatters() {
+      static auto* sFormatters = new std::unordered_set<const BaseLogFormatter*>();
+      return *sFormatters;
+    }
+  };
+
+  /**
+   * @brief Registers a formatter and its call site during static initialisation.
+   */
+  struct FormatterRegistrar {
+    explicit FormatterRegistrar(BaseLogFormatter& __formatter) : _mSite(__formatter.GetCallSite()) {
+      FormatterRegistry::Register(__formatter);
+    }
+    MAKE_NON_COPYABLE(FormatterRegistrar);
+
+    CallSiteRegistrar _mSite;
   };
 
   template <size_t... N>
   struct StringLiteral {
     static constexpr size_t TotalSize = (N + ... + 0);  // Calculate total size including null terminator
+    static constexpr size_t FirstSize = [] {            // Length of the first concatenated literal
+      size_t sizes[] = {N..., 1};
+      return sizes[0] - 1;
+    }();
     char                    Value[TotalSize];
 
     // Constructor to concatenate string literals
@@ -84,24 +154,79 @@ namespace SNJ {
     return StringLiteral<N...>(str...);
   }
 
-  template <StringLiteral FormatString, class... CArgs>
-  class LogFormatter : public BaseLogFormatter {
-   public:
-    inline static LogFormatter<FormatString, CArgs...> instance{};
-
-    constexpr LogFormatter() : BaseLogFormatter(FormatString.Value) {}
+  template <class T>
+  const char* PrintData(const char* __data, std::ostringstream& __stream) {
+    return FastLogCodec<T>::Render(__data, __stream);
+  }
 
-    template <class T>
-    const char* PrintData(const char* __data, std::ostringstream& __stream) const {
-      if constexpr (std::is_same_v<std::decay_t<T>, std::string> || std::is_same_v<T, const char*>) {
-        std::string str(__data);
-        __stream << str;
-        return __data + str.size() + 1;
+  /**
+   * @brief Signal-safe counterpart of PrintData. Types that need operator<< are shown as `<?>`.
+   * @return end of the argument, or nullptr after one whose codec has no fixed size: the rest
+   *         of the record cannot be located without the codec.
+   */
+  template <class T>
+  const char* PrintDataSignalSafe(const char* __data, SignalSafeWriter& __writer) {
+    if constexpr (kIsStringArgument<T>) {
+      __writer.Append(FastLogCodec<T>::View(__data));
+      return __data;
+    } else {
+      if constexpr (std::is_same_v<T, bool>) {
+        __writer.Append(*__data ? "true" : "false");
+      } else if constexpr (std::is_same_v<T, char>) {
+        __writer.Append(*__data);
+      } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+        T value;
+        memcpy(&value, __data, sizeof(T));
+        if constexpr (std::is_signed_v<T>) {
+          __writer.AppendSigned(static_cast<std::int64_t>(value));
+        } else {
+          __writer.AppendUnsigned(static_cast<std::uint64_t>(value));
+        }
+      } else if constexpr (std::is_floating_point_v<T>) {
+        T value;
+        memcpy(&value, __data, sizeof(T));
+        __writer.AppendDouble(static_cast<double>(value));
       } else {
-        __stream << *(reinterpret_cast<const T*>(__data));
-        return __data + sizeof(T);
+        __writer.Append("<?>");
+        if constexpr (requires { FastLogCodec<T>::kFixedSize; }) {
+          return __data + FastLogCodec<T>::kFixedSize;
+        } else {
+          return nullptr;
+        }
       }
+      return __data + sizeof(T);
     }
+  }
+
+  /**
+   * @brief Decodes one argument as the value of a structured field: numbers stay numbers,
+   *        everything else is rendered to text and written as a string.
+   */
+  template <class T>
+  const char* WriteFieldData(const char* __data, StructuredWriter& __writer, std::ostringstream& __scratch) {
+    if constexpr (kIsStringArgument<T>) {
+      __writer.String(FastLogCodec<T>::View(__data));
+      return __data;
+    } else if constexpr (std::is_arithmetic_v<T>) {
+      T value;
+      memcpy(&value, __data, sizeof(T));
+      __writer.Number(value);
+      return __data + sizeof(T);
+    } else {
+      __scratch.str({});
+      const char* next = PrintData<T>(__data, __scratch);
+      __writer.String(__scratch.view());
+      return next;
+    }
+  }
+
+  template <StringLiteral FormatString, StringLiteral Category, class... CArgs>
+  class LogFormatter : public BaseLogFormatter {
+   public:
+    inline static LogFormatter<FormatString, Category, CArgs...> instance{};
+    inline static FormatterRegistrar                             sRegistrar{instance};
+
+    constexpr LogFormatter() : BaseLogFormatter(FormatString.Value, FormatString.FirstSize, Category.Value) {}
 
     template <typename... Args>
     typename std::enable_if<sizeof...(Args) == 0>::type Format(const char* __data, const char* __formatStr,
@@ -122,81 +247,388 @@ namespace SNJ {
     }
 
     void Evaluate(const char* __data, std::ostringstream& __stream) const override {
-      Format<std::decay_t<CArgs>...>(__data, BaseLogFormatter::_mFormatString.data(), __stream);
+      Format<ArgumentType<CArgs>...>(__data, BaseLogFormatter::_mFormatString.data(), __stream);
+    }
+
+    void EvaluateSignalSafe([[maybe_unused]] const char* __data, SignalSafeWriter& __writer) const override {
+      std::string_view format = _mFormatString;
+      ((format = formatSignalSafe<ArgumentType<CArgs>>(__data, format, __writer)), ...);
+      __writer.Append(format);
+    }
+
+    void Rebase([[maybe_unused]] char* __data, [[maybe_unused]] std::ptrdiff_t __delta) const override {
+      ((__data = __data ? RebaseArgument<ArgumentType<CArgs>>(__data, __delta) : nullptr), ...);
+    }
+
+   private:
+    template <class T>
+    static std::string_view formatSignalSafe(const char*& __data, std::string_view __format,
+                                             SignalSafeWriter& __writer) {
+      std::size_t placeholder = __format.find("{}");
+      if (placeholder == std::string_view::npos || !__data) {
+        return __format;
+      }
+      __writer.Append(__format.substr(0, placeholder));
+      __data = PrintDataSignalSafe<T>(__data, __writer);
+      return __format.substr(placeholder + 2);
     }
   };
 
-  struct LogMessage {
-    BaseLogFormatter* _mFormatter;         ///< Pointer to the formatter for the message.
-    char              _mDataBuffer[1024];  ///< Buffer to store message data.
+  /**
+   * @class KvLogFormatter
+   * @brief Formatter for LOG_*_KV records. FormatString is `site:message` followed by one
+   *        `\x1f`-separated name per argument, so only the values travel through the queue.
+   */
+  template <StringLiteral FormatString, StringLiteral Category, class... CArgs>
+  class KvLogFormatter : public BaseLogFormatter {
+   public:
+    inline static KvLogFormatter<FormatString, Category, CArgs...> instance{};
+    inline static FormatterRegistrar                               sRegistrar{instance};
+
+    constexpr KvLogFormatter() : BaseLogFormatter(FormatString.Value, FormatString.FirstSize, Category.Value) {}
+
+    /// Text form: `site:message name=value name=value`.
+    void Evaluate(const char* __data, std::ostringstream& __stream) const override {
+      std::string_view names = _mFormatString;
+      std::size_t      end   = names.find(kSeparator);
+      __stream << names.substr(0, end);
+      (printField<ArgumentType<CArgs>>(__data, names, __stream), ...);
+    }
+
+    void EvaluateFields(const char* __data, StructuredWriter& __writer, std::ostringstream& __scratch) const override {
+      std::string_view names   = _mFormatString;
+      std::size_t      end     = names.find(kSeparator);
+      std::string_view message = names.substr(0, end);
+      message.remove_prefix(std::min(message.size(), _mSiteLength + 1));
+      __writer.Field("msg", message);
+      (writeField<ArgumentType<CArgs>>(__data, names, __writer, __scratch), ...);
+    }
+
+    void EvaluateSignalSafe([[maybe_unused]] const char* __data, SignalSafeWriter& __writer) const override {
+      std::string_view names = _mFormatString;
+      __writer.Append(names.substr(0, names.find(kSeparator)));
+      (appendFieldSignalSafe<ArgumentType<CArgs>>(__data, names, __writer), ...);
+    }
+
+    void Rebase([[maybe_unused]] char* __data, [[maybe_unused]] std::ptrdiff_t __delta) const override {
+      ((__data = __data ? RebaseArgument<ArgumentType<CArgs>>(__data, __delta) : nullptr), ...);
+    }
+
+    inline static constexpr char kSeparator = '\x1f';
+
+   private:
+    static std::string_view nextName(std::string_view& __names) {
+      __names.remove_prefix(__names.find(kSeparator) + 1);
+      return __names.substr(0, __names.find(kSeparator));
+    }
+
+    template <class T>
+    static void printField(const char*& __data, std::string_view& __names, std::ostringstream& __stream) {
+      __stream << ' ' << nextName(__names) << '=';
+      __data = PrintData<T>(__data, __stream);
+    }
+
+    template <class T>
+    static void writeField(const char*& __data, std::string_view& __names, StructuredWriter& __writer,
+                           std::ostringstream& __scratch) {
+      __writer.Key(nextName(__names));
+      __data = WriteFieldData<T>(__data, __writer, __scratch);
+    }
 
     template <class T>
-    char* CopyData(char* __buffer, T& __data) {
-      if constexpr (std::is_same_v<std::decay_t<T>, std::string>) {
-        memcpy(__buffer, __data.c_str(), __data.size());
-        __buffer[__data.size()] = '\0';
-        return __buffer + __data.size() + 1;
-      } else if constexpr (std::is_same_v<std::decay_t<T>, const char*>) {
-        std::size_t length = strlen(__data);
-        memcpy(__buffer, __data, length);
-        __buffer[length] = '\0';
-        return __buffer + length + 1;
+    static void appendFieldSignalSafe(const char*& __data, std::string_view& __names, SignalSafeWriter& __writer) {
+      __writer.Append(' ');
+      __writer.Append(nextName(__names));
+      __writer.Append('=');
+      if (__data) {
+        __data = PrintDataSignalSafe<T>(__data, __writer);
       } else {
-        *(reinterpret_cast<std::decay_t<T>*>(__buffer)) = __data;
-        return __buffer + sizeof(T);
+        __writer.Append("<?>");  // Follows an argument that could not be skipped.
       }
     }
+  };
 
-    template <class Arg, class... Args>
-    void CopyArgs(char* __buffer, Arg& __arg, Args&... __args) {
-      __buffer = CopyData(__buffer, __arg);
-      CopyArgs(__buffer, __args...);
+  /**
+   * @class OversizedRecordFormatter
+   * @brief Stands in for the formatter of a record whose arguments do not fit into a
+   *        LogMessage. The record carries the original formatter and the size it needed.
+   */
+  class OversizedRecordFormatter : public BaseLogFormatter {
+   public:
+    static OversizedRecordFormatter instance;
+
+    constexpr OversizedRecordFormatter() : BaseLogFormatter("oversized record") {}
+
+    static char* Encode(char* __buffer, const BaseLogFormatter* __formatter, std::size_t __size) {
+      __buffer = MemcpyCodec<const BaseLogFormatter*>::Encode(__buffer, __formatter);
+      return MemcpyCodec<std::size_t>::Encode(__buffer, __size);
     }
 
-    template <class Arg>
-    void CopyArgs(char* __buffer, Arg& __arg) {
-      __buffer = CopyData(__buffer, __arg);
+    void Evaluate(const char* __data, std::ostringstream& __stream) const override {
+      std::size_t             size;
+      const BaseLogFormatter* formatter = decode(__data, size);
+      __stream << formatter->GetText() << " [record dropped: its arguments need " << size << " bytes]";
     }
 
+    void EvaluateFields(const char* __data, StructuredWriter& __writer, std::ostringstream&) const override {
+      std::size_t size;
+      __writer.Field("msg", std::string_view("record dropped, its arguments are too large"));
+      __writer.Field("statement", decode(__data, size)->GetText());
+      __writer.Key("bytes");
+      __writer.Number(size);
+    }
+
+    void EvaluateSignalSafe(const char* __data, SignalSafeWriter& __writer) const override {
+      std::size_t size;
+      __writer.Append(decode(__data, size)->GetText());
+      __writer.Append(" [record dropped: its arguments need ");
+      __writer.AppendUnsigned(size);
+      __writer.Append(" bytes]");
+    }
+
+    void Rebase(char* __data, std::ptrdiff_t __delta) const override {
+      using Address  = MemcpyCodec<const BaseLogFormatter*>;
+      auto formatter = reinterpret_cast<std::intptr_t>(Address::Decode(__data));
+      Address::Encode(__data, reinterpret_cast<const BaseLogFormatter*>(formatter + __delta));
+    }
+
+    /// Formatter of the dropped record.
+    static const BaseLogFormatter* GetOriginal(const char* __data) {
+      return MemcpyCodec<const BaseLogFormatter*>::Decode(__data);
+    }
+
+   private:
+    static const BaseLogFormatter* decode(const char* __data, std::size_t& __size) {
+      __size = MemcpyCodec<std::size_t>::Decode(__data + sizeof(const BaseLogFormatter*));
+      return MemcpyCodec<const BaseLogFormatter*>::Decode(__data);
+    }
+  };
+
+  inline OversizedRecordFormatter OversizedRecordFormatter::instance{};
+
+  /**
+   * @class InternDictionaryFormatter
+   * @brief Marks dictionary records, which define the ID of an Interned string for the records
+   *        that follow in their queue. The consumer adds them to the InternDictionary instead of
+   *        writing them.
+   */
+  class InternDictionaryFormatter : public BaseLogFormatter {
+   public:
+    static InternDictionaryFormatter instance;
+
+    constexpr InternDictionaryFormatter() : BaseLogFormatter("interned string") {}
+
+    static void Define(const char* __data) {
+      std::uint32_t id = MemcpyCodec<std::uint32_t>::Decode(__data);
+      __data += sizeof(std::uint32_t);
+      InternDictionary::Current().Define(id, StringCodec::View(__data));
+    }
+
+    /// Only reached by code rendering raw queue contents, e.g. benchmarks.
+    void Evaluate(const char* __data, std::ostringstream& __stream) const override {
+      __stream << "interned #" << MemcpyCodec<std::uint32_t>::Decode(__data) << ": ";
+      __data += sizeof(std::uint32_t);
+      StringCodec::Render(__data, __stream);
+    }
+  };
+
+  inline InternDictionaryFormatter InternDictionaryFormatter::instance{};
+
+  /**
+   * @brief Steady clock time a record was enqueued at, in ns; tags the LogMessage constructor.
+   */
+  struct EnqueueTime {
+    std::int64_t _mNs;
+  };
+
+  struct LogMessage {
+    BaseLogFormatter* _mFormatter;         ///< Pointer to the formatter for the message.
+    std::int64_t      _mEnqueueNs;         ///< Steady clock at enqueue; 0 if not stamped.
+    std::uint16_t     _mDataSize;          ///< Bytes of _mDataBuffer in use, level included.
+    char              _mDataBuffer[1024];  ///< Buffer to store message data.
+
+    /// Room for the arguments, after the level.
+    inline static constexpr std::size_t kMaxArgumentSize = sizeof(_mDataBuffer) - sizeof(LogLevel);
+
     LogMessage() noexcept = default;
 
     LogMessage(BaseLogFormatter* __formatter, LogLevel __logLevel) {
       _mFormatter                                = __formatter;
+      _mEnqueueNs                                = 0;
+      _mDataSize                                 = sizeof(LogLevel);
       *reinterpret_cast<LogLevel*>(_mDataBuffer) = __logLevel;
     }
 
+    /**
+     * @brief Encodes @p __args with their FastLogCodec. If they do not fit, the record is
+     *        replaced by one saying so, rendered by OversizedRecordFormatter.
+     */
     template <class... Args>
     LogMessage(BaseLogFormatter* __formatter, LogLevel __logLevel, Args&&... __args)
         : LogMessage(__formatter, __logLevel) {
-      CopyArgs(_mDataBuffer + sizeof(LogLevel), __args...);
+      char*       end  = _mDataBuffer + sizeof(LogLevel);
+      std::size_t size = (std::size_t{0} + ... + ArgumentCodec<Args>::EncodedSize(__args));
+      if (size > kMaxArgumentSize) [[unlikely]] {
+        _mFormatter = &OversizedRecordFormatter::instance;
+        end         = OversizedRecordFormatter::Encode(end, __formatter, size);
+      } else {
+        ((end = ArgumentCodec<Args>::Encode(end, __args)), ...);
+      }
+      _mDataSize = static_cast<std::uint16_t>(end - _mDataBuffer);
+    }
+
+    template <class... Args>
+    LogMessage(EnqueueTime __enqueueTime, BaseLogFormatter* __formatter, LogLevel __logLevel, Args&&... __args)
+        : LogMessage(__formatter, __logLevel, std::forward<Args>(__args)...) {
+      _mEnqueueNs = __enqueueTime._mNs;
+    }
+
+    /**
+     * @brief Same call site with byte-identical arguments.
+     */
+    bool IsRepeatOf(const LogMessage& __other) const {
+      return _mFormatter == __other._mFormatter && _mDataSize == __other._mDataSize &&
+             memcmp(_mDataBuffer, __other._mDataBuffer, _mDataSize) == 0;
     }
   };
 
-  using MessageQueue = SPSCQueue<LogMessage>;
+  using MessageQueue   = SPSCQueue<LogMessage>;
+  using FlightRecorder = FlightRecorderRing<LogMessage>;
   class ThreadScopedQueueManager {
    public:
     class ThreadScopedQueue {
      public:
       ThreadScopedQueue(std::shared_ptr<ThreadScopedQueueManager> __threadScopedQueueManager)
-          : _mThreadScopedQueueManager(__threadScopedQueueManager) {
-        _mThreadScopedQueueManager->RegisterScopedQueue(this);
+          : _mThreadScopedQueueManager(__threadScopedQueueManager),
+            _mThreadId(static_cast<std::int32_t>(syscall(SYS_gettid))) {
+        QueuePlacement placement = _mThreadScopedQueueManager->GetQueuePlacement();
+        if (!placement._mDirectory.empty()) {
+          _mMessageQueue = PersistentQueueFile<MessageQueue>::Create(placement._mDirectory);
+          _mPersistent   = _mMessageQueue != nullptr;
+        }
+        if (_mPersistent && placement._mRegistry) {
+          _mRegistry     = placement._mRegistry;
+          _mRegistrySlot =
+              _mRegistry->Publish(placement._mOwner, PersistentQueueFile<MessageQueue>::GetPath(_mMessageQueue));
+        }
+        if (!_mMessageQueue) {
+          _mMessageQueue = new MessageQueue();
+        }
+        if (_mRegistrySlot < 0) {
+          _mThreadScopedQueueManager->RegisterScopedQueue(this);
+        }
       }
 
-      MessageQueue& GetMessageQueue() { return _mMessageQueue; }
+      MessageQueue& GetMessageQueue() { return *_mMessageQueue; }
+
+      const ThreadScopedQueueManager* GetManager() const { return _mThreadScopedQueueManager.get(); }
+
+      StringInterner& GetInterner() { return _mInterner; }
+
+      std::int32_t GetThreadId() const { return _mThreadId; }
+
+      QueueStats GetStats() const {
+        return {_mThreadId, _mMessageQueue->GetSize(), _mMessageQueue->GetHighWaterMark(),
+                _mMessageQueue->GetEnqueueSpins(), _mMessageQueue->GetDrops()};
+      }
+
+      /**
+       * @brief Ring of this thread's flight recorder records, allocated on first use.
+       */
+      FlightRecorder& GetFlightRecorder(std::size_t __depth) {
+        FlightRecorder* flightRecorder = _mFlightRecorder.load(std::memory_order_relaxed);
+        if (!flightRecorder) [[unlikely]] {
+          flightRecorder = new FlightRecorder(__depth);
+          _mFlightRecorder.store(flightRecorder, std::memory_order_relaxed);
+          _mThreadScopedQueueManager->RegisterFlightRecorder(flightRecorder);
+        }
+        return *flightRecorder;
+      }
 
       MAKE_NON_COPYABLE(ThreadScopedQueue);
 
-      ~ThreadScopedQueue() { _mThreadScopedQueueManager->UnRegisterThreadScopedQueue(this); }
+      ~ThreadScopedQueue() {
+        if (_mRegistrySlot < 0) {
+          _mThreadScopedQueueManager->UnRegisterThreadScopedQueue(this);
+          _mThreadScopedQueueManager->RetireQueueStats(GetStats());
+        }
+        if (_mPersistent) {
+          PersistentQueueFile<MessageQueue>::Release(_mMessageQueue);
+        } else {
+          delete _mMessageQueue;
+        }
+        if (_mRegistrySlot >= 0) {
+          _mRegistry->Retire(_mRegistrySlot);  // The daemon drains what is left and removes the file.
+        }
+        if (FlightRecorder* flightRecorder = _mFlightRecorder.load(std::memory_order_relaxed)) {
+          _mThreadScopedQueueManager->RetireFlightRecorder(flightRecorder);
+        }
+      }
 
      private:
       std::shared_ptr<ThreadScopedQueueManager> _mThreadScopedQueueManager;
-      MessageQueue                              _mMessageQueue;
+      std::int32_t                              _mThreadId;
+      MessageQueue*                             _mMessageQueue{nullptr};
+      bool                                      _mPersistent{false};  ///< Lives in a PersistentQueueFile mapping.
+      SharedQueueRegistry*                      _mRegistry{nullptr};
+      int                                       _mRegistrySlot{-1};  ///< >= 0 if consumed by the daemon.
+      std::atomic<FlightRecorder*>              _mFlightRecorder{nullptr};  ///< Producer-only, lazily created.
+      StringInterner                            _mInterner;                 ///< Producer-only.
+    };
+
+    /**
+     * @brief Where queues of newly registering threads are allocated and who consumes them.
+     */
+    struct QueuePlacement {
+      std::string          _mDirectory;           ///< File backed if not empty, heap otherwise.
+      SharedQueueRegistry* _mRegistry{nullptr};  ///< Published to the logging daemon if set.
+      std::uintptr_t       _mOwner{0};           ///< Logger identity announced with the queue.
     };
 
    public:
+    /**
+     * @brief Places queues of threads that register from now on in files under @p __directory.
+     *        An empty path switches back to heap allocated queues.
+     */
+    void SetPersistentDirectory(std::string __directory) {
+      std::lock_guard<std::mutex> lock(_mLock);
+      _mPlacement._mDirectory = std::move(__directory);
+    }
+
+    /**
+     * @brief Hands queues of threads that register from now on to the logging daemon through
+     *        @p __registry instead of the in-process consumer.
+     */
+    void SetSharedRegistry(SharedQueueRegistry* __registry, std::uintptr_t __owner, std::string __directory) {
+      std::lock_guard<std::mutex> lock(_mLock);
+      _mPlacement = QueuePlacement{std::move(__directory), __registry, __owner};
+    }
+
+    QueuePlacement GetQueuePlacement() {
+      std::lock_guard<std::mutex> lock(_mLock);
+      return _mPlacement;
+    }
+
+    /**
+     * @brief Consumes a queue owned by another process, e.g. in the logging daemon.
+     */
+    void AttachQueue(MessageQueue* __queue) {
+      std::lock_guard<std::mutex> lock(_mLock);
+      _mAttachedQueues.insert(__queue);
+    }
+
+    void DetachQueue(MessageQueue* __queue) {
+      std::lock_guard<std::mutex> lock(_mLock);
+      _mAttachedQueues.erase(__queue);
+    }
+
     void RegisterScopedQueue(ThreadScopedQueue* __threadScopedQueue) {
       std::lock_guard<std::mutex> lock(_mLock);
       _mThreadScopedQueues.insert(__threadScopedQueue);
+      for (auto& slot : _mSignalSafeQueues) {
+        ThreadScopedQueue* expected = nullptr;
+        if (slot.compare_exchange_strong(expected, __threadScopedQueue, std::memory_order_release)) break;
+      }
     }
 
     void UnRegisterThreadScopedQueue(ThreadScopedQueue* __threadScopedQueue) {
@@ -205,80 +637,1210 @@ namespace SNJ {
       }
       std::lock_guard<std::mutex> lock(_mLock);
       _mThreadScopedQueues.erase(__threadScopedQueue);
+      for (auto& slot : _mSignalSafeQueues) {
+        ThreadScopedQueue* expected = __threadScopedQueue;
+        if (slot.compare_exchange_strong(expected, nullptr, std::memory_order_release)) break;
+      }
+    }
+
+    /**
+     * @brief Lock-free iteration for signal handlers. Only covers the first kMaxSignalSafeQueues
+     *        threads that registered.
+     */
+    template <class TCallback>
+    void ForEachQueueSignalSafe(TCallback __callback) {
+      for (auto& slot : _mSignalSafeQueues) {
+        if (ThreadScopedQueue* threadScopedQueue = slot.load(std::memory_order_acquire)) {
+          __callback(threadScopedQueue->GetMessageQueue());
+        }
+      }
     }
 
+    /**
+     * @brief Calls @p __callback with every queue, and with the tid of its producer thread if
+     *        it takes a second argument.
+     */
     template <class TCallback>
     void ForEachQueue(TCallback __callback) {
       std::lock_guard<std::mutex> lock(_mLock);
       for (auto threadScopedQueue : _mThreadScopedQueues) {
-        __callback(threadScopedQueue->GetMessageQueue());
+        visitQueue(__callback, threadScopedQueue->GetMessageQueue(), threadScopedQueue->GetThreadId());
+      }
+      for (auto queue : _mAttachedQueues) {
+        visitQueue(__callback, *queue, PersistentQueueFile<MessageQueue>::GetThreadId(queue));  // Queue files only.
       }
     }
 
+    /**
+     * @brief Appends the stats of every queue of a live thread of this process, followed by
+     *        the summed counters of threads that exited, if any did.
+     */
+    void CollectQueueStats(std::vector<QueueStats>& __stats) {
+      std::lock_guard<std::mutex> lock(_mLock);
+      for (auto threadScopedQueue : _mThreadScopedQueues) {
+        __stats.push_back(threadScopedQueue->GetStats());
+      }
+      if (_mHasExitedQueues) {
+        __stats.push_back(_mExitedQueueStats);
+      }
+    }
+
+    void RetireQueueStats(const QueueStats& __stats) {
+      std::lock_guard<std::mutex> lock(_mLock);
+      _mHasExitedQueues                  = true;
+      _mExitedQueueStats._mHighWaterMark = std::max(_mExitedQueueStats._mHighWaterMark, __stats._mHighWaterMark);
+      _mExitedQueueStats._mEnqueueSpins += __stats._mEnqueueSpins;
+      _mExitedQueueStats._mDrops        += __stats._mDrops;
+    }
+
+    ~ThreadScopedQueueManager() {
+      for (auto flightRecorder : _mRetiredFlightRecorders) {
+        delete flightRecorder;
+      }
+    }
+
+    /**
+     * @brief Flight recorder rings have their own lock, since they are dumped from inside a
+     *        ForEachQueue() pass.
+     */
+    void RegisterFlightRecorder(FlightRecorder* __flightRecorder) {
+      std::lock_guard<std::mutex> lock(_mFlightRecorderLock);
+      _mFlightRecorders.insert(__flightRecorder);
+    }
+
+    /**
+     * @brief Takes over the ring of an exiting thread, so that its last records still show up
+     *        in the next dump. Only the most recent kMaxRetiredFlightRecorders are kept.
+     */
+    void RetireFlightRecorder(FlightRecorder* __flightRecorder) {
+      std::lock_guard<std::mutex> lock(_mFlightRecorderLock);
+      _mFlightRecorders.erase(__flightRecorder);
+      _mRetiredFlightRecorders.push_back(__flightRecorder);
+      if (_mRetiredFlightRecorders.size() > kMaxRetiredFlightRecorders) {
+        delete _mRetiredFlightRecorders.front();
+        _mRetiredFlightRecorders.erase(_mRetiredFlightRecorders.begin());
+      }
+    }
+
+    /**
+     * @brief Visits every ring, then frees the rings of exited threads.
+     */
+    template <class TCallback>
+    void ForEachFlightRecorder(TCallback __callback) {
+      std::lock_guard<std::mutex> lock(_mFlightRecorderLock);
+      for (auto flightRecorder : _mFlightRecorders) {
+        __callback(*flightRecorder);
+      }
+      for (auto flightRecorder : _mRetiredFlightRecorders) {
+        __callback(*flightRecorder);
+        delete flightRecorder;
+      }
+      _mRetiredFlightRecorders.clear();
+    }
+
    private:
+    template <class TCallback>
+    static void visitQueue(TCallback& __callback, MessageQueue& __queue, std::int32_t __threadId) {
+      if constexpr (std::is_invocable_v<TCallback&, MessageQueue&, std::int32_t>) {
+        __callback(__queue, __threadId);
+      } else {
+        __callback(__queue);
+      }
+    }
+
+    inline static constexpr std::size_t kMaxSignalSafeQueues        = 256;
+    inline static constexpr std::size_t kMaxRetiredFlightRecorders = 64;
+
     std::mutex                             _mLock;
+    QueuePlacement                         _mPlacement;
     std::unordered_set<ThreadScopedQueue*> _mThreadScopedQueues;
+    std::unordered_set<MessageQueue*>      _mAttachedQueues;
+    QueueStats                             _mExitedQueueStats;  ///< Summed over threads that exited.
+    bool                                   _mHasExitedQueues{false};
+    std::mutex                             _mFlightRecorderLock;
+    std::unordered_set<FlightRecorder*>    _mFlightRecorders;
+    std::vector<FlightRecorder*>           _mRetiredFlightRecorders;
+    std::atomic<ThreadScopedQueue*>        _mSignalSafeQueues[kMaxSignalSafeQueues] = {};
   };
 
-  inline MessageQueue& GetThreadScopedMessageQueue(std::shared_ptr<ThreadScopedQueueManager> __threadScopedQueueManager) {
-    thread_local ThreadScopedQueueManager::ThreadScopedQueue sThreadScopedQueue(__threadScopedQueueManager);
-    return sThreadScopedQueue.GetMessageQueue();
+  /**
+   * @brief Called on a thread the first time it gets a queue, if set. Installed by CrashHandler.
+   */
+  inline std::atomic<void (*)()> gThreadQueueHook{nullptr};
+
+  /**
+   * @class ThreadScopedQueues
+   * @brief The calling thread's queues, one per queue manager, i.e. per logger, it has logged
+   *        through; destroyed with the thread.
+   *
+   * The queue used last is cached in trivially initialised thread_locals, so that the common
+   * case of a thread logging through one logger is two TLS loads and a compare, with neither
+   * a TLS guard nor a reference count update.
+   */
+  class ThreadScopedQueues {
+   public:
+    using ThreadScopedQueue = ThreadScopedQueueManager::ThreadScopedQueue;
+
+    static FORCE_INLINE ThreadScopedQueue& Get(const std::shared_ptr<ThreadScopedQueueManager>& __manager) {
+      if (sLastManager == __manager.get()) [[likely]] {
+        return *sLastQueue;
+      }
+      return find(__manager);
+    }
+
+    ~ThreadScopedQueues() {
+      sLastManager = nullptr;
+      sLastQueue   = nullptr;
+    }
+
+   private:
+    static NO_INLINE ThreadScopedQueue& find(const std::shared_ptr<ThreadScopedQueueManager>& __manager) {
+      thread_local ThreadScopedQueues sQueues;
+      auto queue = std::find_if(sQueues._mQueues.begin(), sQueues._mQueues.end(),
+                                [&__manager](const auto& __queue) { return __queue->GetManager() == __manager.get(); });
+      if (queue == sQueues._mQueues.end()) {
+        if (sQueues._mQueues.empty()) {
+          if (auto hook = gThreadQueueHook.load(std::memory_order_acquire)) hook();
+        }
+        queue = sQueues._mQueues.insert(sQueues._mQueues.end(), std::make_unique<ThreadScopedQueue>(__manager));
+      }
+      // A queue keeps its manager alive, so a cached address cannot be reused by another one.
+      sLastManager = __manager.get();
+      sLastQueue   = queue->get();
+      return *sLastQueue;
+    }
+
+    std::vector<std::unique_ptr<ThreadScopedQueue>> _mQueues;
+
+    inline static thread_local constinit const ThreadScopedQueueManager* sLastManager = nullptr;
+    inline static thread_local constinit ThreadScopedQueue*              sLastQueue   = nullptr;
+  };
+
+  inline ThreadScopedQueueManager::ThreadScopedQueue& GetThreadScopedQueue(
+      const std::shared_ptr<ThreadScopedQueueManager>& __threadScopedQueueManager) {
+    return ThreadScopedQueues::Get(__threadScopedQueueManager);
+  }
+
+  inline MessageQueue& GetThreadScopedMessageQueue(
+      const std::shared_ptr<ThreadScopedQueueManager>& __threadScopedQueueManager) {
+    return ThreadScopedQueues::Get(__threadScopedQueueManager).GetMessageQueue();
   }
 
+  /**
+   * @brief Called after a FATAL record is enqueued, if set. Installed by CrashHandler.
+   */
+  inline std::atomic<void (*)()> gFatalHook{nullptr};
+
+  /**
+   * @brief What a producer does when its queue is full.
+   */
+  enum class OverflowPolicy : std::uint8_t {
+    BLOCK,  ///< Spin until the consumer makes room; nothing is lost.
+    DROP,   ///< Discard the record and count it; the producer never waits.
+  };
+
   class FastLogger {
    public:
-    FastLogger(std::string_view __logFileName)
-        : _mFileStream(__logFileName.data()),
-          _mThreadScopedQueueManager(std::make_shared<ThreadScopedQueueManager>()) {}
+    inline static constexpr std::size_t kMaxLoggers = 64;
+
+    /// Logger without any sink; add them with AddSink().
+    FastLogger() : _mThreadScopedQueueManager(std::make_shared<ThreadScopedQueueManager>()) {
+      for (auto& slot : sLoggers) {
+        FastLogger* expected = nullptr;
+        if (slot.compare_exchange_strong(expected, this, std::memory_order_release)) break;
+      }
+    }
+
+    FastLogger(std::string_view __logFileName) : FastLogger() {
+      _mFileSink = std::make_shared<FileSink>(__logFileName);
+      _mFileSinkRaw.store(_mFileSink.get(), std::memory_order_release);
+      _mSinks.push_back(_mFileSink);
+    }
+
+    FastLogger(std::string_view __logsDir, std::string_view __baseFileName, RotationPolicy __rotationPolicy)
+        : FastLogger() {
+      _mFileSink = std::make_shared<FileSink>(__logsDir, __baseFileName, __rotationPolicy);
+      _mFileSinkRaw.store(_mFileSink.get(), std::memory_order_release);
+      _mSinks.push_back(_mFileSink);
+    }
 
     MAKE_NON_COPYABLE(FastLogger);
     MAKE_NON_MOVABLE(FastLogger);
 
     ~FastLogger() noexcept {
-      _mFileStream.flush();
-      _mFileStream.close();
+      FlushPendingRepeats();
+      for (auto& slot : sLoggers) {
+        FastLogger* expected = this;
+        if (slot.compare_exchange_strong(expected, nullptr, std::memory_order_release)) break;
+      }
     }
 
+    /**
+     * @brief Enqueues a record if it passes its call site's threshold or, when the site has no
+     *        override, the logger level.
+     */
     template <class... Args>
     void Log(BaseLogFormatter* __formatter, LogLevel __logLevel, Args&&... __args) {
-      if (__logLevel >= _mLogLevel) {
-        GetThreadScopedMessageQueue(_mThreadScopedQueueManager)
-            .Enqueue(__formatter, __logLevel, std::forward<Args>(__args)...);
+      std::uint8_t siteLevel = __formatter->GetCallSite()._mThreshold.load(std::memory_order_relaxed);
+      LogLevel     threshold = siteLevel == kInheritLogLevel ? _mLogLevel.load(std::memory_order_relaxed)
+                                                             : static_cast<LogLevel>(siteLevel);
+      if (__logLevel >= threshold) {
+        if (__logLevel >= LogLevel::ERROR && flightRecorderLevel() != kFlightRecorderDisabled) [[unlikely]] {
+          _mFlightRecorderTrigger.store(nowNs(), std::memory_order_relaxed);  // Published by the enqueue.
+        }
+        ThreadScopedQueue& scopedQueue = GetThreadScopedQueue(_mThreadScopedQueueManager);
+        (intern(scopedQueue, __args), ...);
+        MessageQueue& queue = scopedQueue.GetMessageQueue();
+        EnqueueTime   stamp{_mTrackLatency.load(std::memory_order_relaxed) ? steadyNs() : 0};
+        if (_mOverflowPolicy.load(std::memory_order_relaxed) == OverflowPolicy::BLOCK) [[likely]] {
+          queue.Enqueue(stamp, __formatter, __logLevel, std::forward<Args>(__args)...);
+        } else {
+          queue.TryEnqueue(stamp, __formatter, __logLevel, std::forward<Args>(__args)...);
+        }
+        if (__logLevel == LogLevel::FATAL) [[unlikely]] {
+          if (auto hook = gFatalHook.load(std::memory_order_acquire)) hook();
+        }
+      } else if (__logLevel >= flightRecorderLevel()) {
+        ThreadScopedQueue& scopedQueue = GetThreadScopedQueue(_mThreadScopedQueueManager);
+        (intern(scopedQueue, __args), ...);
+        scopedQueue.GetFlightRecorder(_mFlightRecorderDepth.load(std::memory_order_relaxed))
+            .Record(__formatter, __logLevel, std::forward<Args>(__args)...);
+      }
+    }
+
+    /**
+     * @brief Lock-free view of every live logger, for crash handling.
+     */
+    template <class TCallback>
+    static void ForEachLoggerSignalSafe(TCallback __callback) {
+      for (auto& slot : sLoggers) {
+        if (FastLogger* logger = slot.load(std::memory_order_acquire)) {
+          __callback(*logger);
+        }
+      }
+    }
+
+    /**
+     * @brief Drains every queue of this logger into @p __fd using only async-signal-safe calls.
+     *
+     * Waits a bounded time for a running consumer pass to finish, then proceeds anyway, e.g.
+     * when the consumer itself is the thread that crashed.
+     */
+    void DrainSignalSafe(int __fd) {
+      pid_t self     = static_cast<pid_t>(syscall(SYS_gettid));
+      bool  acquired = false;
+      for (int spins = 0; spins < 1'000'000 && _mDrainOwner.load(std::memory_order_acquire) != self; ++spins) {
+        if (!_mDrainGuard.exchange(true, std::memory_order_acquire)) {
+          acquired = true;
+          break;
+        }
+      }
+
+      SignalSafeWriter writer(__fd);
+      _mThreadScopedQueueManager->ForEachQueueSignalSafe([&writer](MessageQueue& __queue) {
+        static LogMessage message;  // Off the (possibly alternate, small) signal stack.
+        while (__queue.Dequeue(message)) {
+          if (message._mFormatter == &InternDictionaryFormatter::instance) continue;  // Defining allocates.
+          writer.Append("[CRASH] [");
+          writer.Append(LogLevelToStringView(*reinterpret_cast<const LogLevel*>(message._mDataBuffer)));
+          writer.Append("] ");
+          message._mFormatter->EvaluateSignalSafe(message._mDataBuffer + sizeof(LogLevel), writer);
+          writer.Append('\n');
+        }
+      });
+      writer.Flush();
+
+      if (acquired) {
+        _mDrainGuard.store(false, std::memory_order_release);
+      }
+    }
+
+    /**
+     * @brief Live file of the logger's own file sink, or nullptr. Readable from a signal handler.
+     */
+    const char* GetSignalSafeFilePath() const {
+      FileSink* fileSink = _mFileSinkRaw.load(std::memory_order_acquire);
+      return fileSink ? fileSink->GetLogFile().GetSignalSafePath() : nullptr;
+    }
+
+    void SetLogLevel(LogLevel __logLevel) { _mLogLevel.store(__logLevel, std::memory_order_relaxed); }
+
+    /**
+     * @brief Attributes every record written from now on to its call site and producer thread.
+     *        Costs the consumer two hash lookups per record; 0 turns the profiler off and
+     *        forgets what it accumulated.
+     * @param __topN call sites listed by ReportVolume().
+     */
+    void EnableVolumeProfiler(std::size_t __topN = 20) {
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      _mVolumeTopN = __topN;
+      if (!__topN) {
+        _mSiteVolumes.clear();
+        _mThreadVolumes.clear();
+      }
+    }
+
+    /**
+     * @brief The @p __topN heaviest call sites and every producer thread, by rendered bytes.
+     */
+    VolumeProfile GetVolumeProfile(std::size_t __topN) const {
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      return volumeProfile(__topN);
+    }
+
+    /**
+     * @brief Writes the volume profile to the logger's own sinks, synchronously. Also done by
+     *        LogManager when logging stops.
+     */
+    void ReportVolume() {
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      if (!_mVolumeTopN) return;
+      VolumeProfile profile = volumeProfile(_mVolumeTopN);
+      writeLine(LogLevel::INFO, nullptr,
+                "log volume: " + std::to_string(profile._mRecords) + " records, " + std::to_string(profile._mBytes) +
+                    " bytes from " + std::to_string(profile._mSiteCount) + " call sites; top " +
+                    std::to_string(profile._mSites.size()) + ":");
+      auto share = [&profile](const LogVolume& __volume) {
+        char percent[16];
+        std::snprintf(percent, sizeof(percent), "%5.1f%%",
+                      profile._mBytes ? 100.0 * static_cast<double>(__volume._mBytes) / profile._mBytes : 0.0);
+        return std::string(percent) + " " + std::to_string(__volume._mRecords) + " records " +
+               std::to_string(__volume._mBytes) + " bytes ";
+      };
+      for (LogVolume& site : profile._mSites) {
+        std::replace_if(site._mSite.begin(), site._mSite.end(), [](char __c) { return __c >= 0 && __c < ' '; }, ' ');
+        writeLine(LogLevel::INFO, nullptr, "  " + share(site) + site._mSite);
+      }
+      for (const LogVolume& thread : profile._mThreads) {
+        writeLine(LogLevel::INFO, nullptr, "  " + share(thread) + "thread " + std::to_string(thread._mThreadId));
+      }
+    }
+
+    void SetOverflowPolicy(OverflowPolicy __overflowPolicy) {
+      _mOverflowPolicy.store(__overflowPolicy, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Stamps records at enqueue, one steady clock read per record on the producer, and
+     *        keeps a histogram of the delay until the consumer hands them to the sinks. The
+     *        histogram is reported by GetStats(); disabling leaves it as it is.
+     * @param __summaryInterval if non-zero, at most this often a pass ends with a line giving
+     *        the percentiles of the records written since the previous such line.
+     */
+    void EnableLatencyTracking(bool __enable = true, std::chrono::milliseconds __summaryInterval = {}) {
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      _mLatencySummaryInterval = __enable ? __summaryInterval : std::chrono::milliseconds{};
+      _mNextLatencySummary     = 0;
+      _mIntervalLatency.Reset();
+      _mTrackLatency.store(__enable, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Counters of the consumer and of every producer queue. Readable from any thread,
+     *        waits for a running pass to copy the latency histogram; the name is left empty,
+     *        LogManager fills it in.
+     */
+    LoggerStats GetStats() const {
+      LoggerStats stats;
+      stats._mRecordsWritten   = _mConsumerStats._mRecordsWritten.load(std::memory_order_relaxed);
+      stats._mBytesWritten     = _mConsumerStats._mBytesWritten.load(std::memory_order_relaxed);
+      stats._mPasses           = _mConsumerStats._mPasses.load(std::memory_order_relaxed);
+      stats._mFormatNs         = _mConsumerStats._mFormatNs.load(std::memory_order_relaxed);
+      stats._mWriteNs          = _mConsumerStats._mWriteNs.load(std::memory_order_relaxed);
+      stats._mLastPassFormatNs = _mConsumerStats._mLastPassFormatNs.load(std::memory_order_relaxed);
+      stats._mLastPassWriteNs  = _mConsumerStats._mLastPassWriteNs.load(std::memory_order_relaxed);
+      stats._mConsumerLagNs    = _mConsumerStats._mConsumerLagNs.load(std::memory_order_relaxed);
+      _mThreadScopedQueueManager->CollectQueueStats(stats._mQueues);
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      stats._mWriteLatency = _mWriteLatency;
+      return stats;
+    }
+
+    LogLevel GetLogLevel() const { return _mLogLevel.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Keeps records from @p __recordLevel up to, but excluding, the logger level in a
+     *        per-thread ring of @p __depth records instead of dropping them.
+     *
+     * They are never written on their own. Before the consumer writes an ERROR or FATAL
+     * record, and on DumpFlightRecorder(), the last @p __depth of them across all threads are
+     * rendered in time order, each with the time it was logged. Records of threads served by
+     * the logging daemon are not covered. Can be called while threads log; a new depth only
+     * applies to threads that have not recorded anything yet.
+     */
+    void EnableFlightRecorder(LogLevel __recordLevel = LogLevel::DEBUG, std::size_t __depth = 256) {
+      _mFlightRecorderDepth.store(__depth, std::memory_order_relaxed);
+      _mFlightRecorderLevel.store(__recordLevel, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Renders the flight recorder records not dumped yet, synchronously.
+     */
+    void DumpFlightRecorder() {
+      if (flightRecorderLevel() == kFlightRecorderDisabled) return;
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      dumpFlightRecorder(nowNs(), "dump request");
+    }
+
+    /**
+     * @brief Collapses consecutive identical records (same call site, same argument bytes) from
+     *        one thread into a single "last message repeated N times" line. A repeat is
+     *        suppressed if it arrives within @p __window of the last record actually written.
+     *        Disabled by default. Pending counts are written by FlushPendingRepeats().
+     */
+    void SetDuplicateSuppression(bool __enabled, std::chrono::milliseconds __window = std::chrono::seconds(1)) {
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      _mSuppressDuplicates = __enabled;
+      _mDuplicateWindow    = __window;
+    }
+
+    /**
+     * @brief Writes the "last message repeated N times" lines that duplicate suppression is
+     *        still holding back. Called by the final consumer pass and the destructor.
+     */
+    void FlushPendingRepeats() {
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      if (_mDuplicateStates.empty()) return;
+      for (auto& [queue, state] : _mDuplicateStates) {
+        flushRepeats(state);
+      }
+      if (_mFlushPolicy.load(std::memory_order_relaxed) == FlushPolicy::EVERY_PASS) {
+        for (auto& sink : _mSinks) {
+          sink->Flush();
+        }
+      }
+    }
+
+    /**
+     * @brief Adds a destination. Each record is delivered to every sink whose minimum level it meets.
+     */
+    void AddSink(std::shared_ptr<LogSink> __sink) {
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      _mSinks.push_back(std::move(__sink));
+    }
+
+    void RemoveSink(const std::shared_ptr<LogSink>& __sink) {
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      _mSinks.erase(std::remove(_mSinks.begin(), _mSinks.end(), __sink), _mSinks.end());
+      if (__sink == _mFileSink) {
+        _mFileSinkRaw.store(nullptr, std::memory_order_release);
+        _mFileSink.reset();
       }
     }
 
-    void SetLogLevel(LogLevel __logLevel) { _mLogLevel = __logLevel; }
+    /// The logger's own file sink, nullptr if it was created without one or it was removed.
+    std::shared_ptr<FileSink> GetFileSink() const {
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      return _mFileSink;
+    }
+
+    void SetFlushPolicy(FlushPolicy __flushPolicy) { _mFlushPolicy.store(__flushPolicy, std::memory_order_relaxed); }
+
+    /**
+     * @brief Changes the rotation policy of the logger's own file sink, if any.
+     */
+    void SetRotationPolicy(RotationPolicy __rotationPolicy) {
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      if (_mFileSink) {
+        _mFileSink->GetLogFile().SetPolicy(__rotationPolicy);
+      }
+    }
+
+    /**
+     * @brief Settings changed together by Reconfigure(); empty ones keep their current value.
+     */
+    struct Reconfiguration {
+      std::optional<LogLevel>               _mLevel;
+      std::optional<FlushPolicy>            _mFlushPolicy;
+      std::optional<RotationPolicy>         _mRotationPolicy;
+      std::vector<std::shared_ptr<LogSink>> _mRemovedSinks;
+      std::vector<std::shared_ptr<LogSink>> _mAddedSinks;
+    };
+
+    /**
+     * @brief Applies @p __change as one step. The consumer works under the same lock, so a
+     *        pass sees either none or all of it; producers only see the level, stored last.
+     */
+    void Reconfigure(const Reconfiguration& __change) {
+      std::lock_guard<std::mutex>           lock(_mSinksLock);
+      std::vector<std::shared_ptr<LogSink>> sinks;
+      sinks.reserve(_mSinks.size() + __change._mAddedSinks.size());
+      for (auto& sink : _mSinks) {
+        if (std::find(__change._mRemovedSinks.begin(), __change._mRemovedSinks.end(), sink) ==
+            __change._mRemovedSinks.end()) {
+          sinks.push_back(sink);
+        } else if (sink == _mFileSink) {
+          _mFileSinkRaw.store(nullptr, std::memory_order_release);
+          _mFileSink.reset();
+        }
+      }
+      sinks.insert(sinks.end(), __change._mAddedSinks.begin(), __change._mAddedSinks.end());
+      _mSinks.swap(sinks);
+      if (__change._mFlushPolicy) {
+        _mFlushPolicy.store(*__change._mFlushPolicy, std::memory_order_relaxed);
+      }
+      if (__change._mRotationPolicy && _mFileSink) {
+        _mFileSink->GetLogFile().SetPolicy(*__change._mRotationPolicy);
+      }
+      if (__change._mLevel) {
+        _mLogLevel.store(*__change._mLevel, std::memory_order_relaxed);
+      }
+    }
+
+    /**
+     * @brief Sets the callback for files rotated out by the logger's own file sink, if any.
+     */
+    void SetRotatedCallback(RotatingLogFile::RotatedCallback __callback) {
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      if (_mFileSink) {
+        _mFileSink->GetLogFile().SetRotatedCallback(std::move(__callback));
+      }
+    }
+
+    /**
+     * @brief Backs the queues of threads that first log after this call with files in
+     *        @p __directory, so that records still queued survive a SIGKILL or the OOM killer.
+     *
+     * The producer path is unchanged: the queue is the same object, only its storage is a
+     * MAP_SHARED mapping. Call before the logging threads start; threads that already logged
+     * keep their heap queue.
+     */
+    void EnablePersistentQueues(std::string __directory) {
+      _mThreadScopedQueueManager->SetPersistentDirectory(std::move(__directory));
+    }
+
+    /**
+     * @brief Writes the records left in @p __directory by terminated runs of this executable to
+     *        the sinks of this logger, then removes the queue files. Records whose formatter is
+     *        not one of this binary, e.g. left by another build, are counted and skipped.
+     * @return number of records recovered.
+     */
+    std::size_t RecoverPersistentQueues(const std::string& __directory) {
+      std::lock_guard<std::mutex>      lock(_mSinksLock);
+      InternDictionary                 dictionary;  // Interned IDs of the terminated process.
+      InternDictionary::ScopedOverride scope(dictionary);
+      std::size_t                      definitions = 0;
+      std::size_t                      unknown     = 0;
+      std::size_t recovered = PersistentQueueFile<MessageQueue>::Recover<LogMessage>(
+          __directory, [this, &definitions, &unknown](LogMessage& __message, std::ptrdiff_t __delta) {
+            if (!rebaseRecovered(__message, __delta)) {
+              ++unknown;
+              return;
+            }
+            __message._mEnqueueNs = 0;  // Stamped by another boot's steady clock, if at all.
+            if (consumeDictionaryRecord(__message)) {
+              ++definitions;
+              return;
+            }
+            writeMessage(__message);
+          });
+      recovered -= definitions + unknown;
+      if (recovered != 0) {
+        writeLine(LogLevel::INFO, nullptr,
+                  "recovered " + std::to_string(recovered) + " records queued by a terminated process");
+      }
+      if (unknown != 0) {
+        writeLine(LogLevel::ERROR, nullptr,
+                  "skipped " + std::to_string(unknown) + " recovered records whose formatter is not in this binary");
+      }
+      return recovered;
+    }
+
+    /**
+     * @brief Sends queues of threads that first log after this call to the logging daemon
+     *        behind @p __registry, as files in @p __directory.
+     */
+    void ServeFromDaemon(SharedQueueRegistry* __registry, std::string __directory) {
+      _mThreadScopedQueueManager->SetSharedRegistry(__registry, reinterpret_cast<std::uintptr_t>(this),
+                                                    std::move(__directory));
+    }
+
+    /**
+     * @brief Moves records of queues consumed in process into @p __target without rendering
+     *        them. Used to hand records of threads that logged before the daemon started over
+     *        to it.
+     */
+    void ForwardQueues(MessageQueue& __target) {
+      _mThreadScopedQueueManager->ForEachQueue([&__target, this](MessageQueue& __queue) {
+        while (__queue.Dequeue(_mMessage)) {
+          __target.Enqueue(_mMessage);
+        }
+      });
+    }
+
+    /**
+     * @brief Waits for background work of the sinks, so that a fork() does not copy it half done.
+     */
+    void QuiesceSinks() {
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      for (auto& sink : _mSinks) {
+        sink->Quiesce();
+      }
+    }
+
+    /**
+     * @brief In a forked daemon: drops the queues inherited from the parent, which belong to
+     *        threads that do not exist here, and starts over with an empty queue manager.
+     */
+    void ResetQueuesAfterFork() {
+      // Intentionally leaked: its mutex may have been held by a parent thread at fork time.
+      new std::shared_ptr<ThreadScopedQueueManager>(std::move(_mThreadScopedQueueManager));
+      _mThreadScopedQueueManager = std::make_shared<ThreadScopedQueueManager>();
+      _mDuplicateStates.clear();
+      // Records now come from another process, which may have loaded libraries since the fork.
+      _mVerifyFormatters = true;
+    }
 
     void ConsumeAndWriteLogs() noexcept {
-      _mThreadScopedQueueManager->ForEachQueue([this](auto& queue) {
-        LogMessage message;
-        while (queue.Dequeue(message) != false) {
-          std::ostringstream oss;
-          auto               now   = std::chrono::system_clock::now();
-          std::time_t        now_c = std::chrono::system_clock::to_time_t(now);
-          std::tm            tm_buf;
-          localtime_r(&now_c, &tm_buf);
-          oss << "[" << std::put_time(&tm_buf, "%Y-%m-%d %H:%M:%S") << "] ";
-          auto logLevel = *reinterpret_cast<const LogLevel*>(message._mDataBuffer);
-          oss << "[" << LogLevelToString(logLevel) << "] ";
-          message._mFormatter->Evaluate(message._mDataBuffer + sizeof(LogLevel), oss);
-          _mFileStream << oss.str() << "\n";
-          _mFileStream.flush();
+      std::lock_guard<std::mutex> lock(_mSinksLock);
+      DrainGuard                  guard(*this);
+      std::int64_t                passStart = steadyNs();
+      for (auto& sink : _mSinks) {
+        sink->BeginPass();
+      }
+      if (!_mSuppressDuplicates) {
+        _mThreadScopedQueueManager->ForEachQueue([this](auto& queue, std::int32_t threadId) {
+          LogMessage message;
+          _mConsumingThreadId = threadId;
+          while (queue.Dequeue(message) != false) {
+            if (!skipRecord(message)) writeMessage(message);
+          }
+        });
+      } else {
+        consumeSuppressingDuplicates();
+      }
+      if (_mUnknownFormatterRecords != 0) [[unlikely]] {
+        writeLine(LogLevel::ERROR, nullptr,
+                  "dropped " + std::to_string(_mUnknownFormatterRecords) +
+                      " records whose formatter is not in this binary, e.g. from a library loaded after the fork");
+        _mUnknownFormatterRecords = 0;
+      }
+      if (_mLatencySummaryInterval.count() != 0) {
+        writeLatencySummary(passStart);
+      }
+
+      if (_mFlushPolicy.load(std::memory_order_relaxed) == FlushPolicy::EVERY_PASS) {
+        std::int64_t flushStart = steadyNs();
+        for (auto& sink : _mSinks) {
+          sink->Flush();
+        }
+        _mPassWriteNs += steadyNs() - flushStart;
+      }
+      publishPassStats(passStart);
+    }
+
+   private:
+    using ThreadScopedQueue = ThreadScopedQueueManager::ThreadScopedQueue;
+
+    /**
+     * @brief Gives an Interned argument its ID, sending the dictionary record through the
+     *        queue first if this thread has not used the string with this logger yet. Without
+     *        an ID, kNoId, the argument is encoded with its characters.
+     */
+    template <class T>
+    FORCE_INLINE void intern(ThreadScopedQueue& __queue, const T& __argument) {
+      if constexpr (std::is_same_v<ArgumentType<T>, Interned>) {
+        std::uint32_t id = __queue.GetInterner().Find(__argument.View());
+        __argument.SetId(id != StringInterner::kNoId ? id : internFirstUse(__queue, __argument.View()));
+      }
+    }
+
+    NO_INLINE std::uint32_t internFirstUse(ThreadScopedQueue& __queue, std::string_view __value) {
+      std::uint32_t id = StringInterner::Assign(__value);
+      if (id == StringInterner::kNoId) return id;
+      MessageQueue& queue = __queue.GetMessageQueue();
+      if (_mOverflowPolicy.load(std::memory_order_relaxed) == OverflowPolicy::BLOCK) {
+        queue.Enqueue(&InternDictionaryFormatter::instance, LogLevel::DEBUG, id, __value);
+      } else if (!queue.TryEnqueue(&InternDictionaryFormatter::instance, LogLevel::DEBUG, id, __value)) {
+        return StringInterner::kNoId;  // Retried with the next record using the string.
+      }
+      __queue.GetInterner().MarkSent(__value, id);
+      return id;
+    }
+
+    void consumeSuppressingDuplicates() {
+      auto now = std::chrono::steady_clock::now();
+      ++_mPass;
+      _mThreadScopedQueueManager->ForEachQueue([this, now](auto& queue, std::int32_t threadId) {
+        DuplicateState& state = _mDuplicateStates[&queue];
+        state._mLastSeenPass  = _mPass;
+        _mConsumingThreadId   = threadId;
+        while (queue.Dequeue(_mMessage) != false) {
+          if (skipRecord(_mMessage)) continue;
+          if (state._mHasLast && _mMessage.IsRepeatOf(state._mLast) && now - state._mLastWritten < _mDuplicateWindow) {
+            ++state._mRepeats;
+            continue;
+          }
+          flushRepeats(state);
+          writeMessage(_mMessage);
+          state._mLast        = _mMessage;
+          state._mHasLast     = true;
+          state._mLastWritten = now;
+        }
+        if (now - state._mLastWritten >= _mDuplicateWindow) {
+          flushRepeats(state);
         }
       });
+
+      // Forget queues of threads that have exited, once their pending count is written.
+      for (auto entry = _mDuplicateStates.begin(); entry != _mDuplicateStates.end();) {
+        if (entry->second._mLastSeenPass == _mPass) {
+          ++entry;
+          continue;
+        }
+        flushRepeats(entry->second);
+        entry = _mDuplicateStates.erase(entry);
+      }
     }
-    LogLevel                                  _mLogLevel{LogLevel::INFO};
-    std::ofstream                             _mFileStream;  ///< File stream for logging.
+
+    /**
+     * @brief Marks a consumer pass so that a crash drain does not dequeue concurrently.
+     */
+    class DrainGuard {
+     public:
+      DrainGuard(FastLogger& __logger) : _mLogger(__logger) {
+        while (_mLogger._mDrainGuard.exchange(true, std::memory_order_acquire)) {
+        }
+        _mLogger._mDrainOwner.store(static_cast<pid_t>(syscall(SYS_gettid)), std::memory_order_release);
+      }
+
+      ~DrainGuard() {
+        _mLogger._mDrainOwner.store(0, std::memory_order_relaxed);
+        _mLogger._mDrainGuard.store(false, std::memory_order_release);
+      }
+
+     private:
+      FastLogger& _mLogger;
+    };
+
+    /**
+     * @brief Consumer-side duplicate tracking for one thread queue.
+     */
+    struct DuplicateState {
+      LogMessage                            _mLast;
+      bool                                  _mHasLast{false};
+      std::uint64_t                         _mRepeats{0};
+      std::uint64_t                         _mLastSeenPass{0};
+      std::chrono::steady_clock::time_point _mLastWritten;
+    };
+
+    void flushRepeats(DuplicateState& __state) {
+      if (__state._mRepeats == 0) return;
+      auto logLevel = *reinterpret_cast<const LogLevel*>(__state._mLast._mDataBuffer);
+      writeLine(logLevel, nullptr, "last message repeated " + std::to_string(__state._mRepeats) + " times");
+      __state._mRepeats = 0;
+    }
+
+    /**
+     * @brief Rebases the formatters and static strings of a recovered record, which belong to
+     *        the executable, onto this process's load address.
+     * @return false, leaving the arguments alone, if the formatters are not ones of this binary:
+     *         nothing must be called through them then.
+     */
+    static bool rebaseRecovered(LogMessage& __message, std::ptrdiff_t __delta) {
+      __message._mFormatter =
+          reinterpret_cast<BaseLogFormatter*>(reinterpret_cast<char*>(__message._mFormatter) + __delta);
+      if (!isKnownFormatter(__message._mFormatter)) return false;
+      __message._mFormatter->Rebase(__message._mDataBuffer + sizeof(LogLevel), __delta);
+      return __message._mFormatter != &OversizedRecordFormatter::instance ||
+             isKnownFormatter(OversizedRecordFormatter::GetOriginal(__message._mDataBuffer + sizeof(LogLevel)));
+    }
+
+    static bool isKnownFormatter(const BaseLogFormatter* __formatter) {
+      return __formatter == &OversizedRecordFormatter::instance ||
+             __formatter == &InternDictionaryFormatter::instance || FormatterRegistry::Contains(__formatter);
+    }
+
+    /**
+     * @brief Takes the records that are not to be written out of the stream: dictionary
+     *        records, which are added to the InternDictionary, and, in a logging daemon,
+     *        records whose formatters are not ones of this binary, which are counted.
+     * @return whether @p __message must not be written.
+     */
+    bool skipRecord(const LogMessage& __message) {
+      if (_mVerifyFormatters) [[unlikely]] {
+        auto verified = [this](const BaseLogFormatter* __formatter) {
+          if (_mVerifiedFormatters.contains(__formatter)) return true;
+          if (!isKnownFormatter(__formatter)) return false;
+          _mVerifiedFormatters.insert(__formatter);
+          return true;
+        };
+        bool known = verified(__message._mFormatter) &&
+                     (__message._mFormatter != &OversizedRecordFormatter::instance ||
+                      verified(OversizedRecordFormatter::GetOriginal(__message._mDataBuffer + sizeof(LogLevel))));
+        if (!known) {
+          ++_mUnknownFormatterRecords;
+          return true;
+        }
+      }
+      return consumeDictionaryRecord(__message);
+    }
+
+    /**
+     * @brief Adds a dictionary record to the InternDictionary.
+     * @return whether @p __message was one, in which case it is not written.
+     */
+    static bool consumeDictionaryRecord(const LogMessage& __message) {
+      if (__message._mFormatter != &InternDictionaryFormatter::instance) [[likely]] return false;
+      InternDictionaryFormatter::Define(__message._mDataBuffer + sizeof(LogLevel));
+      return true;
+    }
+
+    /// Writes a record that skipRecord() let through.
+    void writeMessage(const LogMessage& __message) {
+      auto logLevel = *reinterpret_cast<const LogLevel*>(__message._mDataBuffer);
+      if (logLevel >= LogLevel::ERROR && flightRecorderLevel() != kFlightRecorderDisabled) [[unlikely]] {
+        if (std::int64_t trigger = _mFlightRecorderTrigger.exchange(0, std::memory_order_relaxed)) {
+          dumpFlightRecorder(trigger, LogLevelToStringView(logLevel));
+        }
+      }
+      if (!_mVolumeTopN) {
+        writeLine(logLevel, &__message, {});
+        recordLatency(__message);
+        return;
+      }
+      std::uint64_t bytes = _mPassBytes;
+      writeLine(logLevel, &__message, {});
+      recordLatency(__message);
+      bytes = _mPassBytes - bytes;
+
+      LogVolume& site   = _mSiteVolumes[__message._mFormatter];
+      LogVolume& thread = _mThreadVolumes[_mConsumingThreadId];
+      site._mRecords += 1;
+      site._mBytes += bytes;
+      thread._mRecords += 1;
+      thread._mBytes += bytes;
+    }
+
+    void recordLatency(const LogMessage& __message) {
+      if (__message._mEnqueueNs == 0) return;
+      auto latency = static_cast<std::uint64_t>(std::max<std::int64_t>(steadyNs() - __message._mEnqueueNs, 0));
+      _mWriteLatency.Record(latency);
+      _mIntervalLatency.Record(latency);
+    }
+
+    /**
+     * @brief Writes the percentiles of the records written since the last summary, once the
+     *        summary interval has passed since it.
+     */
+    void writeLatencySummary(std::int64_t __now) {
+      if (__now < _mNextLatencySummary) return;
+      bool first           = _mNextLatencySummary == 0;
+      _mNextLatencySummary = __now + std::chrono::nanoseconds(_mLatencySummaryInterval).count();
+      if (first || _mIntervalLatency.GetCount() == 0) return;
+
+      auto micros = [](std::uint64_t __ns) { return static_cast<double>(__ns) / 1e3; };
+      char summary[160];
+      std::snprintf(summary, sizeof(summary),
+                    "write latency: %llu records, p50 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us",
+                    static_cast<unsigned long long>(_mIntervalLatency.GetCount()),
+                    micros(_mIntervalLatency.GetPercentile(0.5)), micros(_mIntervalLatency.GetPercentile(0.99)),
+                    micros(_mIntervalLatency.GetPercentile(0.999)), micros(_mIntervalLatency.GetMax()));
+      _mIntervalLatency.Reset();
+      writeLine(LogLevel::INFO, nullptr, summary);
+    }
+
+    VolumeProfile volumeProfile(std::size_t __topN) const {
+      VolumeProfile profile;
+      profile._mSiteCount = _mSiteVolumes.size();
+      for (const auto& [formatter, volume] : _mSiteVolumes) {
+        profile._mRecords += volume._mRecords;
+        profile._mBytes   += volume._mBytes;
+        profile._mSites.push_back(volume);
+        profile._mSites.back()._mSite = formatter->GetText();
+      }
+      for (const auto& [threadId, volume] : _mThreadVolumes) {
+        profile._mThreads.push_back(volume);
+        profile._mThreads.back()._mThreadId = threadId;
+      }
+      auto        heavier = [](const LogVolume& __a, const LogVolume& __b) { return __a._mBytes > __b._mBytes; };
+      std::size_t top     = std::min(__topN, profile._mSites.size());
+      std::partial_sort(profile._mSites.begin(), profile._mSites.begin() + top, profile._mSites.end(), heavier);
+      profile._mSites.resize(top);
+      std::sort(profile._mThreads.begin(), profile._mThreads.end(), heavier);
+      return profile;
+    }
+
+    static std::int64_t steadyNs() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+          .count();
+    }
+
+    /**
+     * @brief Moves the consumer-local counters of the pass that started at @p __passStart into
+     *        the atomics GetStats() reads.
+     */
+    void publishPassStats(std::int64_t __passStart) {
+      std::int64_t passEnd = steadyNs();
+      std::int64_t since   = _mPreviousPassStart ? _mPreviousPassStart : __passStart;
+      _mPreviousPassStart  = __passStart;
+
+      _mConsumerStats._mPasses.fetch_add(1, std::memory_order_relaxed);
+      _mConsumerStats._mRecordsWritten.fetch_add(_mPassRecords, std::memory_order_relaxed);
+      _mConsumerStats._mBytesWritten.fetch_add(_mPassBytes, std::memory_order_relaxed);
+      _mConsumerStats._mFormatNs.fetch_add(_mPassFormatNs, std::memory_order_relaxed);
+      _mConsumerStats._mWriteNs.fetch_add(_mPassWriteNs, std::memory_order_relaxed);
+      _mConsumerStats._mLastPassFormatNs.store(_mPassFormatNs, std::memory_order_relaxed);
+      _mConsumerStats._mLastPassWriteNs.store(_mPassWriteNs, std::memory_order_relaxed);
+      _mConsumerStats._mConsumerLagNs.store(static_cast<std::uint64_t>(passEnd - since), std::memory_order_relaxed);
+      _mPassRecords  = 0;
+      _mPassBytes    = 0;
+      _mPassFormatNs = 0;
+      _mPassWriteNs  = 0;
+    }
+
+    static std::int64_t nowNs() {
+      return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+          .count();
+    }
+
+    LogLevel flightRecorderLevel() const { return _mFlightRecorderLevel.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Renders the flight recorder records logged up to @p __upTo (ns since epoch) that
+     *        were not dumped before, oldest first.
+     */
+    void dumpFlightRecorder(std::int64_t __upTo, std::string_view __reason) {
+      _mFlightRecords.clear();
+      _mThreadScopedQueueManager->ForEachFlightRecorder([this, __upTo](FlightRecorder& __flightRecorder) {
+        std::uint64_t head     = __flightRecorder.GetHead();
+        std::uint64_t capacity = __flightRecorder.GetCapacity();
+        std::uint64_t index    = std::max(__flightRecorder._mDumped, head > capacity ? head - capacity : 0);
+        for (; index < head; ++index) {
+          FlightRecord& record = _mFlightRecords.emplace_back();
+          if (!__flightRecorder.Read(index, record._mMessage, record._mTimestamp)) {
+            _mFlightRecords.pop_back();
+            continue;
+          }
+          if (record._mTimestamp > __upTo) {
+            _mFlightRecords.pop_back();  // Logged after the trigger; left for the next dump.
+            break;
+          }
+        }
+        __flightRecorder._mDumped = index;
+      });
+      if (_mFlightRecords.empty()) return;
+
+      std::stable_sort(
+          _mFlightRecords.begin(), _mFlightRecords.end(),
+          [](const FlightRecord& __a, const FlightRecord& __b) { return __a._mTimestamp < __b._mTimestamp; });
+      std::size_t count = _mFlightRecords.size();
+      std::size_t depth = _mFlightRecorderDepth.load(std::memory_order_relaxed);
+      std::size_t first = count > depth ? count - depth : 0;
+
+      writeLine(LogLevel::INFO, nullptr,
+                "flight recorder: last " + std::to_string(count - first) + " records before " +
+                    std::string(__reason));
+      for (std::size_t i = first; i < _mFlightRecords.size(); ++i) {
+        const LogMessage& message = _mFlightRecords[i]._mMessage;
+        writeLine(*reinterpret_cast<const LogLevel*>(message._mDataBuffer), &message, {},
+                  std::chrono::system_clock::time_point(std::chrono::nanoseconds(_mFlightRecords[i]._mTimestamp)));
+      }
+      writeLine(LogLevel::INFO, nullptr, "flight recorder: end");
+    }
+
+    /**
+     * @brief Renders a line lazily, once per format actually needed, and hands it to the sinks.
+     * @param __message record to render, or nullptr for a consumer generated line @p __text.
+     * @param __time time to print; the current time if default constructed.
+     */
+    void writeLine(LogLevel __logLevel, const LogMessage* __message, std::string_view __text,
+                   std::chrono::system_clock::time_point __time = {}) {
+      bool rendered[kRenderFormatCount] = {};
+      bool flush                        = _mFlushPolicy.load(std::memory_order_relaxed) == FlushPolicy::EVERY_RECORD;
+      bool written                      = false;
+
+      for (auto& sink : _mSinks) {
+        if (!sink->Accepts(__logLevel)) continue;
+
+        auto         format = static_cast<std::size_t>(sink->GetFormat());
+        std::int64_t start  = steadyNs();
+        if (!rendered[format]) {
+          render(sink->GetFormat(), __logLevel, __message, __text, __time, _mRendered[format]);
+          rendered[format] = true;
+          std::int64_t now = steadyNs();
+          _mPassFormatNs += now - start;
+          start = now;
+        }
+        sink->Write(_mRendered[format].data(), _mRendered[format].size());
+        if (flush) {
+          sink->Flush();
+        }
+        _mPassWriteNs += steadyNs() - start;
+        _mPassBytes += _mRendered[format].size();
+        written = true;
+      }
+      _mPassRecords += written;
+    }
+
+    void render(RenderFormat __format, LogLevel __logLevel, const LogMessage* __message, std::string_view __text,
+                std::chrono::system_clock::time_point __time, std::string& __output) {
+      auto        now   = __time == std::chrono::system_clock::time_point{} ? std::chrono::system_clock::now() : __time;
+      std::time_t now_c = std::chrono::system_clock::to_time_t(now);
+      std::tm     tm_buf;
+      localtime_r(&now_c, &tm_buf);
+
+      if (__format == RenderFormat::TEXT) {
+        _mStream.str({});
+        _mStream << "[" << std::put_time(&tm_buf, "%Y-%m-%d %H:%M:%S") << "] ";
+        _mStream << "[" << LogLevelToString(__logLevel) << "] ";
+        if (__message) {
+          __message->_mFormatter->Evaluate(__message->_mDataBuffer + sizeof(LogLevel), _mStream);
+        } else {
+          _mStream << __text;
+        }
+        _mStream << "\n";
+        __output = _mStream.str();
+        return;
+      }
+
+      char timestamp[32];
+      std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &tm_buf);
+
+      __output.clear();
+      if (__format == RenderFormat::JSON) __output += '{';
+      StructuredWriter writer(__format, __output);
+      writer.Field("ts", std::string_view(timestamp));
+      writer.Field("level", LogLevelToString(__logLevel));
+      if (__message) {
+        writer.Field("site", __message->_mFormatter->GetSite());
+        __message->_mFormatter->EvaluateFields(__message->_mDataBuffer + sizeof(LogLevel), writer, _mStream);
+      } else {
+        writer.Field("msg", __text);
+      }
+      if (__format == RenderFormat::JSON) __output += '}';
+      __output += '\n';
+    }
+
+   public:
+    std::atomic<LogLevel>                     _mLogLevel{LogLevel::INFO};
     std::shared_ptr<ThreadScopedQueueManager> _mThreadScopedQueueManager;
+
+   private:
+    mutable std::mutex                    _mSinksLock;  ///< Guards sinks and settings against the consumer pass.
+    std::vector<std::shared_ptr<LogSink>> _mSinks;
+    std::shared_ptr<FileSink>             _mFileSink;  ///< Sink created from the constructor arguments.
+    std::ostringstream                    _mStream;    ///< Consumer-only scratch stream, reused across records.
+    std::string                           _mRendered[kRenderFormatCount];
+
+    std::atomic<FlushPolicy>                                _mFlushPolicy{FlushPolicy::EVERY_RECORD};
+    bool                                                    _mSuppressDuplicates{false};
+    std::chrono::milliseconds                               _mDuplicateWindow{std::chrono::seconds(1)};
+    std::unordered_map<const MessageQueue*, DuplicateState> _mDuplicateStates;
+    std::uint64_t                                           _mPass{0};
+    LogMessage                                              _mMessage;  ///< Consumer-only dequeue slot.
+    std::atomic<OverflowPolicy>                             _mOverflowPolicy{OverflowPolicy::BLOCK};
+
+    /**
+     * @brief Consumer counters published once per pass; on a line of their own so that
+     *        publishing them does not disturb the fields producers read.
+     */
+    struct alignas(64) ConsumerStats {
+      std::atomic<std::uint64_t> _mRecordsWritten{0};
+      std::atomic<std::uint64_t> _mBytesWritten{0};
+      std::atomic<std::uint64_t> _mPasses{0};
+      std::atomic<std::uint64_t> _mFormatNs{0};
+      std::atomic<std::uint64_t> _mWriteNs{0};
+      std::atomic<std::uint64_t> _mLastPassFormatNs{0};
+      std::atomic<std::uint64_t> _mLastPassWriteNs{0};
+      std::atomic<std::uint64_t> _mConsumerLagNs{0};
+    };
+
+    ConsumerStats _mConsumerStats;
+    std::uint64_t _mPassRecords{0};  ///< Consumer-only, current pass.
+    std::uint64_t _mPassBytes{0};
+    std::int64_t  _mPassFormatNs{0};
+    std::int64_t  _mPassWriteNs{0};
+    std::int64_t  _mPreviousPassStart{0};
+
+    // Volume profiler, consumer state under the sinks lock.
+    std::size_t                                            _mVolumeTopN{0};  ///< 0 while the profiler is off.
+    std::unordered_map<const BaseLogFormatter*, LogVolume> _mSiteVolumes;
+    std::unordered_map<std::int32_t, LogVolume>            _mThreadVolumes;
+    std::int32_t                                           _mConsumingThreadId{0};  ///< Producer of the queue drained.
+
+    // Formatter checks of a logging daemon, consumer state under the sinks lock.
+    bool                                        _mVerifyFormatters{false};
+    std::unordered_set<const BaseLogFormatter*> _mVerifiedFormatters;  ///< Checked once each.
+    std::uint64_t                               _mUnknownFormatterRecords{0};  ///< Dropped this pass.
+
+    // Write latency, consumer state under the sinks lock.
+    std::atomic<bool>         _mTrackLatency{false};  ///< Read by producers.
+    LatencyHistogram          _mWriteLatency;         ///< Since tracking was first enabled.
+    LatencyHistogram          _mIntervalLatency;      ///< Since the last summary line.
+    std::chrono::milliseconds _mLatencySummaryInterval{0};
+    std::int64_t              _mNextLatencySummary{0};  ///< Steady clock ns; 0 until the first pass.
+
+    /**
+     * @brief Flight recorder record copied out of a ring for a dump.
+     */
+    struct FlightRecord {
+      std::int64_t _mTimestamp;
+      LogMessage   _mMessage;
+    };
+
+    inline static constexpr LogLevel kFlightRecorderDisabled = static_cast<LogLevel>(0xFF);
+
+    std::atomic<LogLevel>     _mFlightRecorderLevel{kFlightRecorderDisabled};  ///< Lowest level recorded.
+    std::atomic<std::size_t>  _mFlightRecorderDepth{256};
+    std::atomic<std::int64_t> _mFlightRecorderTrigger{0};  ///< Time of the last ERROR/FATAL not dumped for yet.
+    std::vector<FlightRecord> _mFlightRecords;             ///< Consumer-only dump scratch.
+
+    std::atomic<bool>      _mDrainGuard{false};  ///< Held by whoever is dequeuing: consumer pass or crash drain.
+    std::atomic<pid_t>     _mDrainOwner{0};
+    std::atomic<FileSink*> _mFileSinkRaw{nullptr};
+
+    inline static std::atomic<FastLogger*> sLoggers[kMaxLoggers] = {};
+  };
+
+  /**
+   * @class LoggerHandle
+   * @brief Non-owning reference to a FastLogger, taken by the LOG_* macros so that a log call
+   *        updates no reference count. Converts implicitly from the logger or a shared_ptr to
+   *        it; LogManager::CreateLoggerHandle() returns one whose logger lives as long as the
+   *        manager.
+   */
+  class LoggerHandle {
+   public:
+    LoggerHandle(FastLogger& __logger) noexcept : _mLogger(&__logger) {}
+
+    LoggerHandle(const std::shared_ptr<FastLogger>& __logger) noexcept : _mLogger(__logger.get()) {}
+
+    FastLogger* operator->() const noexcept { return _mLogger; }
+
+    FastLogger& operator*() const noexcept { return *_mLogger; }
+
+    FastLogger* Get() const noexcept { return _mLogger; }
+
+   private:
+    FastLogger* _mLogger;
   };
 
-  template <StringLiteral FormatString, class... Args>
-  inline static void WriteLog(std::shared_ptr<FastLogger> __logger, LogLevel __logLevel, Args&&... __args) {
-    __logger->Log(&LogFormatter<FormatString, Args...>::instance, __logLevel, std::forward<Args>(__args)...);
+  // Naming sRegistrar instantiates it, so that the call site registers during static initialisation.
+  template <StringLiteral FormatString, StringLiteral Category, class... Args>
+  inline static void WriteLog(LoggerHandle __logger, LogLevel __logLevel, Args&&... __args) {
+    using Formatter = LogFormatter<FormatString, Category, Args...>;
+    static_cast<void>(&Formatter::sRegistrar);
+    __logger->Log(&Formatter::instance, __logLevel, std::forward<Args>(__args)...);
   }
 
-#define FAST_LOG(logger, logLevel, formatString, ...) \
-  SNJ::WriteLog<SNJ::makeStringLiteral(__PRETTY_FUNCTION__, ":", formatString)>(logger, logLevel, ##__VA_ARGS__);
+  template <StringLiteral FormatString, StringLiteral Category, class... Args>
+  inline static void WriteKvLog(LoggerHandle __logger, LogLevel __logLevel, Args&&... __args) {
+    using Formatter = KvLogFormatter<FormatString, Category, Args...>;
+    static_cast<void>(&Formatter::sRegistrar);
+    __logger->Log(&Formatter::instance, __logLevel, std::forward<Args>(__args)...);
+  }
+
+/**
+ * FAST_LOG_CAT tags the statement with a category literal, whose level can then be changed at
+ * runtime with CallSiteRegistry::SetCategoryLevel(). The site prefix of every record is the
+ * `Class::method@file.cpp:line` of SNJ_CALL_SITE().
+ */
+#define FAST_LOG_CAT(logger, logLevel, category, formatString, ...)                                              \
+  SNJ::WriteLog<SNJ::makeStringLiteral(SNJ_CALL_SITE(), ":", formatString), SNJ::makeStringLiteral(category)>( \
+    logger, logLevel, ##__VA_ARGS__);
+
+#define FAST_LOG(logger, logLevel, formatString, ...) FAST_LOG_CAT(logger, logLevel, "", formatString, ##__VA_ARGS__)
 
 #define LOG_DEBUG(logger, formatString, ...) FAST_LOG(logger, SNJ::LogLevel::DEBUG, formatString, ##__VA_ARGS__)
 
@@ -288,6 +1850,130 @@ namespace SNJ {
 
 #define LOG_FATAL(logger, formatString, ...) FAST_LOG(logger, SNJ::LogLevel::FATAL, formatString, ##__VA_ARGS__)
 
+#define LOG_DEBUG_CAT(logger, category, formatString, ...) \
+  FAST_LOG_CAT(logger, SNJ::LogLevel::DEBUG, category, formatString, ##__VA_ARGS__)
+#define LOG_INFO_CAT(logger, category, formatString, ...) \
+  FAST_LOG_CAT(logger, SNJ::LogLevel::INFO, category, formatString, ##__VA_ARGS__)
+#define LOG_ERROR_CAT(logger, category, formatString, ...) \
+  FAST_LOG_CAT(logger, SNJ::LogLevel::ERROR, category, formatString, ##__VA_ARGS__)
+#define LOG_FATAL_CAT(logger, category, formatString, ...) \
+  FAST_LOG_CAT(logger, SNJ::LogLevel::FATAL, category, formatString, ##__VA_ARGS__)
+
+/**
+ * Structured records: LOG_INFO_KV(logger, "order", "id", id, "px", px).
+ * Field names are literals concatenated into the formatter's StringLiteral; only the values are
+ * copied into the record. Up to 16 name/value pairs, at least one.
+ */
+#define SNJ_KV_SELECT(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, \
+                    _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, NAME, ...)                   \
+  NAME
+#define SNJ_KV_ODD(...) LOG_KV_arguments_must_be_name_value_pairs
+#define SNJ_KV_NAMES(...) SNJ_KV_SELECT(__VA_ARGS__, SNJ_KV_N16, SNJ_KV_ODD, SNJ_KV_N15, SNJ_KV_ODD, \
+  SNJ_KV_N14, SNJ_KV_ODD, SNJ_KV_N13, SNJ_KV_ODD, SNJ_KV_N12, SNJ_KV_ODD, SNJ_KV_N11, SNJ_KV_ODD, SNJ_KV_N10, \
+  SNJ_KV_ODD, SNJ_KV_N9, SNJ_KV_ODD, SNJ_KV_N8, SNJ_KV_ODD, SNJ_KV_N7, SNJ_KV_ODD, SNJ_KV_N6, SNJ_KV_ODD, \
+  SNJ_KV_N5, SNJ_KV_ODD, SNJ_KV_N4, SNJ_KV_ODD, SNJ_KV_N3, SNJ_KV_ODD, SNJ_KV_N2, SNJ_KV_ODD, SNJ_KV_N1, \
+  SNJ_KV_ODD)(__VA_ARGS__)
+#define SNJ_KV_VALUES(...) SNJ_KV_SELECT(__VA_ARGS__, SNJ_KV_V16, SNJ_KV_ODD, SNJ_KV_V15, SNJ_KV_ODD, \
+  SNJ_KV_V14, SNJ_KV_ODD, SNJ_KV_V13, SNJ_KV_ODD, SNJ_KV_V12, SNJ_KV_ODD, SNJ_KV_V11, SNJ_KV_ODD, SNJ_KV_V10, \
+  SNJ_KV_ODD, SNJ_KV_V9, SNJ_KV_ODD, SNJ_KV_V8, SNJ_KV_ODD, SNJ_KV_V7, SNJ_KV_ODD, SNJ_KV_V6, SNJ_KV_ODD, \
+  SNJ_KV_V5, SNJ_KV_ODD, SNJ_KV_V4, SNJ_KV_ODD, SNJ_KV_V3, SNJ_KV_ODD, SNJ_KV_V2, SNJ_KV_ODD, SNJ_KV_V1, \
+  SNJ_KV_ODD)(__VA_ARGS__)
+#define SNJ_KV_N1(name, value) "\x1f", name
+#define SNJ_KV_V1(name, value) value
+#define SNJ_KV_N2(name, value, ...) "\x1f", name, SNJ_KV_N1(__VA_ARGS__)
+#define SNJ_KV_V2(name, value, ...) value, SNJ_KV_V1(__VA_ARGS__)
+#define SNJ_KV_N3(name, value, ...) "\x1f", name, SNJ_KV_N2(__VA_ARGS__)
+#define SNJ_KV_V3(name, value, ...) value, SNJ_KV_V2(__VA_ARGS__)
+#define SNJ_KV_N4(name, value, ...) "\x1f", name, SNJ_KV_N3(__VA_ARGS__)
+#define SNJ_KV_V4(name, value, ...) value, SNJ_KV_V3(__VA_ARGS__)
+#define SNJ_KV_N5(name, value, ...) "\x1f", name, SNJ_KV_N4(__VA_ARGS__)
+#define SNJ_KV_V5(name, value, ...) value, SNJ_KV_V4(__VA_ARGS__)
+#define SNJ_KV_N6(name, value, ...) "\x1f", name, SNJ_KV_N5(__VA_ARGS__)
+#define SNJ_KV_V6(name, value, ...) value, SNJ_KV_V5(__VA_ARGS__)
+#define SNJ_KV_N7(name, value, ...) "\x1f", name, SNJ_KV_N6(__VA_ARGS__)
+#define SNJ_KV_V7(name, value, ...) value, SNJ_KV_V6(__VA_ARGS__)
+#define SNJ_KV_N8(name, value, ...) "\x1f", name, SNJ_KV_N7(__VA_ARGS__)
+#define SNJ_KV_V8(name, value, ...) value, SNJ_KV_V7(__VA_ARGS__)
+#define SNJ_KV_N9(name, value, ...) "\x1f", name, SNJ_KV_N8(__VA_ARGS__)
+#define SNJ_KV_V9(name, value, ...) value, SNJ_KV_V8(__VA_ARGS__)
+#define SNJ_KV_N10(name, value, ...) "\x1f", name, SNJ_KV_N9(__VA_ARGS__)
+#define SNJ_KV_V10(name, value, ...) value, SNJ_KV_V9(__VA_ARGS__)
+#define SNJ_KV_N11(name, value, ...) "\x1f", name, SNJ_KV_N10(__VA_ARGS__)
+#define SNJ_KV_V11(name, value, ...) value, SNJ_KV_V10(__VA_ARGS__)
+#define SNJ_KV_N12(name, value, ...) "\x1f", name, SNJ_KV_N11(__VA_ARGS__)
+#define SNJ_KV_V12(name, value, ...) value, SNJ_KV_V11(__VA_ARGS__)
+#define SNJ_KV_N13(name, value, ...) "\x1f", name, SNJ_KV_N12(__VA_ARGS__)
+#define SNJ_KV_V13(name, value, ...) value, SNJ_KV_V12(__VA_ARGS__)
+#define SNJ_KV_N14(name, value, ...) "\x1f", name, SNJ_KV_N13(__VA_ARGS__)
+#define SNJ_KV_V14(name, value, ...) value, SNJ_KV_V13(__VA_ARGS__)
+#define SNJ_KV_N15(name, value, ...) "\x1f", name, SNJ_KV_N14(__VA_ARGS__)
+#define SNJ_KV_V15(name, value, ...) value, SNJ_KV_V14(__VA_ARGS__)
+#define SNJ_KV_N16(name, value, ...) "\x1f", name, SNJ_KV_N15(__VA_ARGS__)
+#define SNJ_KV_V16(name, value, ...) value, SNJ_KV_V15(__VA_ARGS__)
+
+#define FAST_LOG_KV(logger, logLevel, message, ...)                                                  \
+  SNJ::WriteKvLog<SNJ::makeStringLiteral(SNJ_CALL_SITE(), ":", message, SNJ_KV_NAMES(__VA_ARGS__)), \
+                  SNJ::makeStringLiteral("")>(logger, logLevel, SNJ_KV_VALUES(__VA_ARGS__));
+
+#define LOG_DEBUG_KV(logger, message, ...) FAST_LOG_KV(logger, SNJ::LogLevel::DEBUG, message, __VA_ARGS__)
+
+#define LOG_INFO_KV(logger, message, ...) FAST_LOG_KV(logger, SNJ::LogLevel::INFO, message, __VA_ARGS__)
+
+#define LOG_ERROR_KV(logger, message, ...) FAST_LOG_KV(logger, SNJ::LogLevel::ERROR, message, __VA_ARGS__)
+
+#define LOG_FATAL_KV(logger, message, ...) FAST_LOG_KV(logger, SNJ::LogLevel::FATAL, message, __VA_ARGS__)
+
+/**
+ * Filtered variants. The filter state is a `static thread_local` of the expansion, checked
+ * before the arguments are evaluated, so rejected records cost a few instructions.
+ *   FAST_LOG_RATELIMITED: at most nPerSec records per second per thread.
+ *   FAST_LOG_SAMPLED:     each record kept with the given probability.
+ *   FAST_LOG_EVERY_N:     the 1st, (n+1)th, (2n+1)th... record.
+ */
+#define FAST_LOG_FILTERED(filterType, filterArg, logger, logLevel, formatString, ...) \
+  do {                                                                                \
+  static thread_local filterType snjCallSiteFilter;                                 \
+  if (snjCallSiteFilter.Allow(filterArg)) {                                         \
+    FAST_LOG(logger, logLevel, formatString, ##__VA_ARGS__)                         \
+  }                                                                                 \
+  } while (0)
+
+#define FAST_LOG_RATELIMITED(logger, logLevel, nPerSec, formatString, ...) \
+  FAST_LOG_FILTERED(SNJ::RateLimiter, nPerSec, logger, logLevel, formatString, ##__VA_ARGS__)
+
+#define FAST_LOG_SAMPLED(logger, logLevel, probability, formatString, ...) \
+  FAST_LOG_FILTERED(SNJ::Sampler, probability, logger, logLevel, formatString, ##__VA_ARGS__)
+
+#define FAST_LOG_EVERY_N(logger, logLevel, n, formatString, ...) \
+  FAST_LOG_FILTERED(SNJ::EveryN, n, logger, logLevel, formatString, ##__VA_ARGS__)
+
+#define LOG_DEBUG_RATELIMITED(logger, nPerSec, formatString, ...) \
+  FAST_LOG_RATELIMITED(logger, SNJ::LogLevel::DEBUG, nPerSec, formatString, ##__VA_ARGS__)
+#define LOG_INFO_RATELIMITED(logger, nPerSec, formatString, ...) \
+  FAST_LOG_RATELIMITED(logger, SNJ::LogLevel::INFO, nPerSec, formatString, ##__VA_ARGS__)
+#define LOG_ERROR_RATELIMITED(logger, nPerSec, formatString, ...) \
+  FAST_LOG_RATELIMITED(logger, SNJ::LogLevel::ERROR, nPerSec, formatString, ##__VA_ARGS__)
+#define LOG_FATAL_RATELIMITED(logger, nPerSec, formatString, ...) \
+  FAST_LOG_RATELIMITED(logger, SNJ::LogLevel::FATAL, nPerSec, formatString, ##__VA_ARGS__)
+
+#define LOG_DEBUG_SAMPLED(logger, probability, formatString, ...) \
+  FAST_LOG_SAMPLED(logger, SNJ::LogLevel::DEBUG, probability, formatString, ##__VA_ARGS__)
+#define LOG_INFO_SAMPLED(logger, probability, formatString, ...) \
+  FAST_LOG_SAMPLED(logger, SNJ::LogLevel::INFO, probability, formatString, ##__VA_ARGS__)
+#define LOG_ERROR_SAMPLED(logger, probability, formatString, ...) \
+  FAST_LOG_SAMPLED(logger, SNJ::LogLevel::ERROR, probability, formatString, ##__VA_ARGS__)
+#define LOG_FATAL_SAMPLED(logger, probability, formatString, ...) \
+  FAST_LOG_SAMPLED(logger, SNJ::LogLevel::FATAL, probability, formatString, ##__VA_ARGS__)
+
+#define LOG_DEBUG_EVERY_N(logger, n, formatString, ...) \
+  FAST_LOG_EVERY_N(logger, SNJ::LogLevel::DEBUG, n, formatString, ##__VA_ARGS__)
+#define LOG_INFO_EVERY_N(logger, n, formatString, ...) \
+  FAST_LOG_EVERY_N(logger, SNJ::LogLevel::INFO, n, formatString, ##__VA_ARGS__)
+#define LOG_ERROR_EVERY_N(logger, n, formatString, ...) \
+  FAST_LOG_EVERY_N(logger, SNJ::LogLevel::ERROR, n, formatString, ##__VA_ARGS__)
+#define LOG_FATAL_EVERY_N(logger, n, formatString, ...) \
+  FAST_LOG_EVERY_N(logger, SNJ::LogLevel::FATAL, n, formatString, ##__VA_ARGS__)
+
 }  // namespace SNJ
 
 #endif
@@ -0,0 +1,87 @@
+#ifndef FLIGHTRECORDER_HPP
+#define FLIGHTRECORDER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#include "Macros.hpp"
+
+namespace SNJ {
+
+  /**
+   * @class FlightRecorderRing
+   * @brief Per thread, overwrite-oldest ring of records that are kept in memory and only
+   *        rendered when a dump is requested.
+   *
+   * The owning thread is the only writer and never waits: each entry carries a sequence
+   * counter that is odd while the entry is being rewritten, so a reader on the consumer
+   * thread detects and skips entries overwritten under its feet (seqlock).
+   */
+  template <class T>
+  class FlightRecorderRing {
+   public:
+    /// @param __depth rounded up to a power of two.
+    explicit FlightRecorderRing(std::size_t __depth) {
+      std::size_t capacity = 1;
+      while (capacity < __depth) capacity <<= 1;
+      _mMask    = capacity - 1;
+      _mEntries = std::make_unique<Entry[]>(capacity);
+    }
+
+    std::size_t GetCapacity() const { return _mMask + 1; }
+
+    template <class... Args>
+    FORCE_INLINE void Record(Args&&... __args) {
+      std::uint64_t index    = _mHead.load(std::memory_order_relaxed);
+      Entry&        entry    = _mEntries[index & _mMask];
+      std::uint32_t sequence = entry._mSequence.load(std::memory_order_relaxed);
+      entry._mSequence.store(sequence + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      entry._mTimestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::system_clock::now().time_since_epoch())
+                              .count();
+      new (&entry._mRecord) T(std::forward<Args>(__args)...);
+      entry._mSequence.store(sequence + 2, std::memory_order_release);
+      _mHead.store(index + 1, std::memory_order_release);
+    }
+
+    /// Index one past the newest record.
+    std::uint64_t GetHead() const { return _mHead.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Copies record @p __index out of the ring.
+     * @return false if it has been, or is being, overwritten.
+     */
+    bool Read(std::uint64_t __index, T& __record, std::int64_t& __timestamp) const {
+      const Entry&  entry  = _mEntries[__index & _mMask];
+      std::uint32_t before = entry._mSequence.load(std::memory_order_acquire);
+      if (before & 1) return false;
+      memcpy(static_cast<void*>(&__record), &entry._mRecord, sizeof(T));
+      __timestamp = entry._mTimestamp;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return entry._mSequence.load(std::memory_order_relaxed) == before &&
+             GetHead() - __index <= GetCapacity();
+    }
+
+    /// Consumer-only: first index not rendered by a previous dump.
+    std::uint64_t _mDumped{0};
+
+   private:
+    struct Entry {
+      std::atomic<std::uint32_t> _mSequence{0};
+      std::int64_t               _mTimestamp{0};
+      T                          _mRecord;
+    };
+
+    std::unique_ptr<Entry[]>   _mEntries;
+    std::size_t                _mMask;
+    std::atomic<std::uint64_t> _mHead{0};
+  };
+}  // namespace SNJ
+
+#endif  // FLIGHTRECORDER_HPP
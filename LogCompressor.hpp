@@ -0,0 +1,198 @@
+#ifndef LOGCOMPRESSOR_HPP
+#define LOGCOMPRESSOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(SNJ_FASTLOGGER_USE_ZLIB)
+#include <zlib.h>
+#endif
+
+#include "Lz4Frame.hpp"
+#include "NonCopyMovable.hpp"
+
+namespace SNJ {
+
+  enum class CompressionCodec : std::uint8_t {
+    LZ4,  ///< Built-in LZ4 frame writer, produces `<file>.lz4`.
+    ZLIB  ///< gzip via zlib, produces `<file>.gz`. Needs SNJ_FASTLOGGER_USE_ZLIB and -lz.
+  };
+
+  struct CompressionPolicy {
+    CompressionCodec _mCodec{CompressionCodec::LZ4};
+    std::size_t      _mMaxConcurrency{1};  ///< Number of compressor threads.
+    bool             _mRemoveSource{true};  ///< Delete the rotated file once compressed.
+  };
+
+  /**
+   * @class LogCompressor
+   * @brief Compresses rotated log files on low priority background threads.
+   *
+   * Only files that have already been rotated out and closed are ever submitted, so the live
+   * file is never read. Workers run at the lowest CPU and idle I/O priority and keep off the
+   * CPU the consumer thread is pinned to.
+   */
+  class LogCompressor {
+   public:
+    LogCompressor(CompressionPolicy __policy) : _mPolicy(__policy) {
+      CPU_ZERO(&_mAllowedCpus);
+      sched_getaffinity(0, sizeof(_mAllowedCpus), &_mAllowedCpus);
+      std::size_t workers = std::max<std::size_t>(1, _mPolicy._mMaxConcurrency);
+      for (std::size_t i = 0; i < workers; ++i) {
+        _mWorkers.emplace_back([this]() { workerLoop(); });
+      }
+    }
+
+    MAKE_NON_COPYABLE(LogCompressor);
+    MAKE_NON_MOVABLE(LogCompressor);
+
+    /**
+     * @brief Finishes the queued files and joins the workers.
+     */
+    ~LogCompressor() {
+      {
+        std::lock_guard<std::mutex> lock(_mLock);
+        _mStopping = true;
+      }
+      _mCondition.notify_all();
+      for (auto& worker : _mWorkers) {
+        worker.join();
+      }
+    }
+
+    void Submit(std::string __filePath) {
+      {
+        std::lock_guard<std::mutex> lock(_mLock);
+        _mPendingFiles.push_back(std::move(__filePath));
+      }
+      _mCondition.notify_one();
+    }
+
+    /**
+     * @brief CPU the workers must stay off, normally the one the consumer thread is pinned to.
+     */
+    void SetExcludedCpu(int __cpu) { _mExcludedCpu.store(__cpu, std::memory_order_relaxed); }
+
+    /**
+     * @brief Compresses @p __filePath next to itself and optionally removes the source.
+     * @return false if the file could not be read or the output could not be written.
+     */
+    static bool CompressFile(const std::string& __filePath, CompressionCodec __codec, bool __removeSource) {
+      std::string outputPath = __filePath + (__codec == CompressionCodec::ZLIB ? ".gz" : ".lz4");
+      std::string tmpPath    = outputPath + ".tmp";
+
+      bool compressed = false;
+      if (__codec == CompressionCodec::ZLIB) {
+        compressed = compressZlib(__filePath, tmpPath);
+      } else {
+        std::ifstream in(__filePath, std::ios::binary);
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        compressed = in && out && Lz4FrameWriter::Compress(in, out);
+      }
+
+      std::error_code ec;
+      if (!compressed) {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+      }
+      std::filesystem::rename(tmpPath, outputPath, ec);
+      if (ec) return false;
+      if (__removeSource) {
+        std::filesystem::remove(__filePath, ec);
+      }
+      return true;
+    }
+
+   private:
+    void workerLoop() {
+      lowerPriority();
+      int appliedCpu = -1;
+
+      while (true) {
+        std::string filePath;
+        {
+          std::unique_lock<std::mutex> lock(_mLock);
+          _mCondition.wait(lock, [this]() { return _mStopping || !_mPendingFiles.empty(); });
+          if (_mPendingFiles.empty()) return;
+          filePath = std::move(_mPendingFiles.front());
+          _mPendingFiles.pop_front();
+        }
+
+        int excludedCpu = _mExcludedCpu.load(std::memory_order_relaxed);
+        if (excludedCpu != appliedCpu) {
+          avoidCpu(excludedCpu);
+          appliedCpu = excludedCpu;
+        }
+        CompressFile(filePath, _mPolicy._mCodec, _mPolicy._mRemoveSource);
+      }
+    }
+
+    static void lowerPriority() {
+      pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+      setpriority(PRIO_PROCESS, tid, 19);
+#if defined(SYS_ioprio_set)
+      constexpr int kIoprioWhoProcess = 1;
+      constexpr int kIoprioClassIdle  = 3;
+      constexpr int kIoprioClassShift = 13;
+      syscall(SYS_ioprio_set, kIoprioWhoProcess, tid, kIoprioClassIdle << kIoprioClassShift);
+#endif
+    }
+
+    void avoidCpu(int __cpu) const {
+      if (__cpu < 0) return;
+      cpu_set_t cpus = _mAllowedCpus;
+      CPU_CLR(__cpu, &cpus);
+      if (CPU_COUNT(&cpus) == 0) return;  // Single CPU box, nothing to move to.
+      pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+
+    static bool compressZlib([[maybe_unused]] const std::string& __inputPath,
+                             [[maybe_unused]] const std::string& __outputPath) {
+#if defined(SNJ_FASTLOGGER_USE_ZLIB)
+      std::ifstream in(__inputPath, std::ios::binary);
+      gzFile        out = gzopen(__outputPath.c_str(), "wb1");
+      if (!in || out == nullptr) {
+        if (out != nullptr) gzclose(out);
+        return false;
+      }
+      std::vector<char> buffer(64 * 1024);
+      bool              ok = true;
+      while (ok && in) {
+        in.read(buffer.data(), buffer.size());
+        auto size = static_cast<unsigned>(in.gcount());
+        ok        = size == 0 || gzwrite(out, buffer.data(), size) == static_cast<int>(size);
+      }
+      return gzclose(out) == Z_OK && ok && !in.bad();
+#else
+      return false;
+#endif
+    }
+
+    CompressionPolicy        _mPolicy;
+    cpu_set_t                _mAllowedCpus;  ///< Affinity of the thread that enabled compression.
+    std::atomic<int>         _mExcludedCpu{-1};
+    std::mutex               _mLock;
+    std::condition_variable  _mCondition;
+    std::deque<std::string>  _mPendingFiles;
+    bool                     _mStopping{false};
+    std::vector<std::thread> _mWorkers;
+  };
+}  // namespace SNJ
+
+#endif  // LOGCOMPRESSOR_HPP
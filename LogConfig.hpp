@@ -0,0 +1,334 @@
+#ifndef LOGCONFIG_HPP
+#define LOGCONFIG_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "CallSiteRegistry.hpp"
+#include "LogLevel.hpp"
+#include "LogSink.hpp"
+#include "NonCopyMovable.hpp"
+#include "RotatingLogFile.hpp"
+
+namespace SNJ {
+
+  /**
+   * @brief Extra destination declared for a logger in the configuration file.
+   */
+  struct SinkConfig {
+    enum class Kind : std::uint8_t { STDOUT, FILE, SOCKET, NUL };
+
+    Kind         _mKind{Kind::STDOUT};
+    std::string  _mTarget;  ///< Base file name for FILE, socket path for SOCKET.
+    LogLevel     _mMinLevel{LogLevel::DEBUG};
+    RenderFormat _mFormat{RenderFormat::TEXT};
+  };
+
+  struct LoggerConfig {
+    std::optional<LogLevel>       _mLevel;
+    std::optional<FlushPolicy>    _mFlushPolicy;
+    std::optional<RotationPolicy> _mRotationPolicy;
+    std::vector<SinkConfig>       _mSinks;
+  };
+
+  /**
+   * @class LogConfig
+   * @brief Immutable snapshot of a logging configuration file.
+   *
+   * Line based, `#` starts a comment. Global keys come first, then one section per logger,
+   * named after the base file name given to LogManager::CreateLogger():
+   * @code
+   *   level = INFO                   # every logger
+   *   flush = pass                   # record | pass
+   *   category.net = DEBUG
+   *   site.OrderBook::onTrade = DEBUG
+   *
+   *   [logger orders]
+   *   level = DEBUG
+   *   flush = record
+   *   rotate.size = 104857600        # bytes, 0 disables
+   *   rotate.interval = 3600         # seconds, 0 disables
+   *   sink = stdout INFO text        # stdout|null [level [text|json|logfmt]]
+   *   sink = file orders_audit ERROR json
+   *   sink = socket /run/log.sock INFO logfmt
+   * @endcode
+   */
+  class LogConfig {
+   public:
+    /**
+     * @brief Parses @p __input. On error nullptr is returned and @p __error names the line.
+     */
+    static std::shared_ptr<const LogConfig> Parse(std::istream& __input, std::string& __error) {
+      auto          config = std::make_shared<LogConfig>();
+      LoggerConfig* logger = nullptr;
+      std::string   line;
+      for (int number = 1; std::getline(__input, line); ++number) {
+        std::string_view text = trim(std::string_view(line).substr(0, line.find('#')));
+        if (text.empty()) continue;
+
+        if (text.front() == '[') {
+          std::string_view section = trim(text.substr(1, text.find(']') - 1));
+          if (text.back() != ']' || section.substr(0, 7) != "logger ") {
+            return fail(__error, number, "expected [logger <name>]");
+          }
+          logger = &config->_mLoggers[std::string(trim(section.substr(7)))];
+          continue;
+        }
+
+        std::size_t equals = text.find('=');
+        if (equals == std::string_view::npos) {
+          return fail(__error, number, "expected key = value");
+        }
+        std::string_view key   = trim(text.substr(0, equals));
+        std::string_view value = trim(text.substr(equals + 1));
+        if (!(logger ? parseLoggerKey(*logger, key, value) : parseGlobalKey(*config, key, value))) {
+          return fail(__error, number, "invalid entry '" + std::string(key) + "'");
+        }
+      }
+      return config;
+    }
+
+    static std::shared_ptr<const LogConfig> Load(const std::string& __path, std::string& __error) {
+      std::ifstream input(__path);
+      if (!input) {
+        __error = __path + ": cannot open";
+        return nullptr;
+      }
+      auto config = Parse(input, __error);
+      if (!config) __error = __path + ":" + __error;
+      return config;
+    }
+
+    std::optional<LogLevel>                          _mDefaultLevel;
+    std::optional<FlushPolicy>                       _mFlushPolicy;
+    CallSiteRegistry::Rules                          _mCategoryLevels;
+    CallSiteRegistry::Rules                          _mSiteLevels;
+    std::map<std::string, LoggerConfig, std::less<>> _mLoggers;
+
+   private:
+    static std::shared_ptr<const LogConfig> fail(std::string& __error, int __line, const std::string& __message) {
+      __error = std::to_string(__line) + ": " + __message;
+      return nullptr;
+    }
+
+    static std::string_view trim(std::string_view __text) {
+      const char* kSpaces = " \t\r";
+      std::size_t begin   = __text.find_first_not_of(kSpaces);
+      if (begin == std::string_view::npos) return {};
+      return __text.substr(begin, __text.find_last_not_of(kSpaces) - begin + 1);
+    }
+
+    /// Accepts exactly the names LogLevelStrToEnum knows, which maps anything else to FATAL.
+    static bool parseLevel(std::string_view __text, LogLevel& __logLevel) {
+      __logLevel = LogLevelStrToEnum(std::string(__text));
+      return LogLevelToStringView(__logLevel) == __text;
+    }
+
+    static bool parseFlush(std::string_view __text, FlushPolicy& __flushPolicy) {
+      if (__text == "record") {
+        __flushPolicy = FlushPolicy::EVERY_RECORD;
+      } else if (__text == "pass") {
+        __flushPolicy = FlushPolicy::EVERY_PASS;
+      } else {
+        return false;
+      }
+      return true;
+    }
+
+    /// Decimal digits only; values that overflow are rejected.
+    static bool parseNumber(std::string_view __text, std::uint64_t& __number) {
+      if (__text.empty() || __text.find_first_not_of("0123456789") != std::string_view::npos) return false;
+      auto [end, error] = std::from_chars(__text.data(), __text.data() + __text.size(), __number);
+      return error == std::errc{} && end == __text.data() + __text.size();
+    }
+
+    static bool parseGlobalKey(LogConfig& __config, std::string_view __key, std::string_view __value) {
+      LogLevel logLevel;
+      if (__key == "level") {
+        if (!parseLevel(__value, logLevel)) return false;
+        __config._mDefaultLevel = logLevel;
+        return true;
+      }
+      if (__key == "flush") {
+        FlushPolicy flushPolicy;
+        if (!parseFlush(__value, flushPolicy)) return false;
+        __config._mFlushPolicy = flushPolicy;
+        return true;
+      }
+      if (__key.substr(0, 9) == "category." && __key.size() > 9 && parseLevel(__value, logLevel)) {
+        __config._mCategoryLevels.emplace_back(std::string(__key.substr(9)), logLevel);
+        return true;
+      }
+      if (__key.substr(0, 5) == "site." && __key.size() > 5 && parseLevel(__value, logLevel)) {
+        __config._mSiteLevels.emplace_back(std::string(__key.substr(5)), logLevel);
+        return true;
+      }
+      return false;
+    }
+
+    static bool parseLoggerKey(LoggerConfig& __logger, std::string_view __key, std::string_view __value) {
+      if (__key == "level") {
+        LogLevel logLevel;
+        if (!parseLevel(__value, logLevel)) return false;
+        __logger._mLevel = logLevel;
+        return true;
+      }
+      if (__key == "flush") {
+        FlushPolicy flushPolicy;
+        if (!parseFlush(__value, flushPolicy)) return false;
+        __logger._mFlushPolicy = flushPolicy;
+        return true;
+      }
+      if (__key == "rotate.size" || __key == "rotate.interval") {
+        std::uint64_t number;
+        if (!parseNumber(__value, number)) return false;
+        if (!__logger._mRotationPolicy) __logger._mRotationPolicy.emplace();
+        if (__key == "rotate.size") {
+          __logger._mRotationPolicy->_mMaxFileSize = number;
+        } else {
+          __logger._mRotationPolicy->_mInterval = std::chrono::seconds(number);
+        }
+        return true;
+      }
+      if (__key == "sink") {
+        SinkConfig sink;
+        if (!parseSink(__value, sink)) return false;
+        __logger._mSinks.push_back(std::move(sink));
+        return true;
+      }
+      return false;
+    }
+
+    static bool parseSink(std::string_view __value, SinkConfig& __sink) {
+      std::istringstream       stream{std::string(__value)};
+      std::vector<std::string> words;
+      for (std::string word; stream >> word;) {
+        words.push_back(std::move(word));
+      }
+      if (words.empty()) return false;
+
+      std::size_t next = 1;
+      if (words[0] == "stdout") {
+        __sink._mKind = SinkConfig::Kind::STDOUT;
+      } else if (words[0] == "null") {
+        __sink._mKind = SinkConfig::Kind::NUL;
+      } else if ((words[0] == "file" || words[0] == "socket") && words.size() > 1) {
+        __sink._mKind   = words[0] == "file" ? SinkConfig::Kind::FILE : SinkConfig::Kind::SOCKET;
+        __sink._mTarget = words[1];
+        next            = 2;
+      } else {
+        return false;
+      }
+
+      if (next < words.size() && !parseLevel(words[next++], __sink._mMinLevel)) return false;
+      if (next < words.size()) {
+        const std::string& format = words[next++];
+        if (format == "text") {
+          __sink._mFormat = RenderFormat::TEXT;
+        } else if (format == "json") {
+          __sink._mFormat = RenderFormat::JSON;
+        } else if (format == "logfmt") {
+          __sink._mFormat = RenderFormat::LOGFMT;
+        } else {
+          return false;
+        }
+      }
+      return next == words.size();
+    }
+  };
+
+  /**
+   * @class ConfigFileWatcher
+   * @brief Invokes a callback on its own thread whenever a file is written or replaced.
+   *
+   * Watches the parent directory with inotify rather than the file itself, so that editors
+   * and deployment tools that replace the file by renaming a new one over it are noticed too.
+   * Only completed writes and renames count: a file that was just created may still be empty
+   * or half written.
+   */
+  class ConfigFileWatcher {
+   public:
+    using Callback = std::function<void()>;
+
+    ConfigFileWatcher(std::string __path, Callback __callback)
+        : _mPath(std::move(__path)), _mCallback(std::move(__callback)) {
+      std::filesystem::path path(_mPath);
+      _mFileName      = path.filename().string();
+      std::string dir = path.has_parent_path() ? path.parent_path().string() : ".";
+
+      _mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+      if (_mInotifyFd >= 0) {
+        inotify_add_watch(_mInotifyFd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        _mThread = std::thread([this]() { watch(); });
+      }
+    }
+
+    MAKE_NON_COPYABLE(ConfigFileWatcher);
+    MAKE_NON_MOVABLE(ConfigFileWatcher);
+
+    ~ConfigFileWatcher() {
+      _mStop.store(true, std::memory_order_relaxed);
+      if (_mThread.joinable()) {
+        _mThread.join();
+      }
+      if (_mInotifyFd >= 0) {
+        close(_mInotifyFd);
+      }
+    }
+
+    bool IsWatching() const { return _mInotifyFd >= 0; }
+
+   private:
+    void watch() {
+      alignas(inotify_event) char buffer[4096];
+      pollfd                      descriptor{_mInotifyFd, POLLIN, 0};
+      while (!_mStop.load(std::memory_order_relaxed)) {
+        if (poll(&descriptor, 1, kPollTimeoutMs) <= 0) continue;
+
+        bool    changed = false;
+        ssize_t length;
+        while ((length = read(_mInotifyFd, buffer, sizeof(buffer))) > 0) {
+          for (char* ptr = buffer; ptr < buffer + length;) {
+            auto* event = reinterpret_cast<inotify_event*>(ptr);
+            if (event->len != 0 && _mFileName == event->name) {
+              changed = true;
+            }
+            ptr += sizeof(inotify_event) + event->len;
+          }
+        }
+        if (changed) {
+          _mCallback();
+        }
+      }
+    }
+
+    inline static constexpr int kPollTimeoutMs = 200;  ///< Bounds how long destruction waits.
+
+    std::string       _mPath;
+    std::string       _mFileName;
+    Callback          _mCallback;
+    int               _mInotifyFd{-1};
+    std::atomic<bool> _mStop{false};
+    std::thread       _mThread;
+  };
+}  // namespace SNJ
+
+#endif  // LOGCONFIG_HPP
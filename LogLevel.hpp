@@ -0,0 +1,50 @@
+#ifndef LOGLEVEL_HPP
+#define LOGLEVEL_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace SNJ {
+
+  enum class LogLevel : std::uint8_t {
+    DEBUG,  ///< Debug-level messages.
+    INFO,   ///< Informational messages.
+    ERROR,  ///< Error-level messages.
+    FATAL   ///< Fatal-level messages.
+  };
+
+  /**
+   * @brief Allocation-free variant of LogLevelToString, safe to call from a signal handler.
+   */
+  inline constexpr std::string_view LogLevelToStringView(LogLevel __logLevel) {
+    switch (__logLevel) {
+      case LogLevel::DEBUG:
+        return "DEBUG";
+      case LogLevel::INFO:
+        return "INFO";
+      case LogLevel::ERROR:
+        return "ERROR";
+      case LogLevel::FATAL:
+        return "FATAL";
+    }
+    return "INVALID";
+  }
+
+  inline static std::string LogLevelToString(LogLevel __logLevel) { return std::string(LogLevelToStringView(__logLevel)); }
+
+  inline static LogLevel LogLevelStrToEnum(const std::string &logLevelStr) {
+    static const std::unordered_map<std::string, LogLevel> logLevelMap = {
+        {"DEBUG", LogLevel::DEBUG},
+        {"INFO", LogLevel::INFO},
+        {"ERROR", LogLevel::ERROR},
+        {"FATAL", LogLevel::FATAL}
+    };
+
+    auto it = logLevelMap.find(logLevelStr);
+    return (it != logLevelMap.end()) ? it->second : LogLevel::FATAL;
+}
+}  // namespace SNJ
+
+#endif  // LOGLEVEL_HPP
@@ -4,8 +4,13 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
 #include <filesystem>
+#include <fstream>
 #include <iomanip>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <sstream>
@@ -14,8 +19,18 @@
 #include <thread>
 #include <vector>
 
+#include <pthread.h>
+#include <sched.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
 #include "FastLogger.hpp"
+#include "LogCompressor.hpp"
+#include "LogConfig.hpp"
 #include "NonCopyMovable.hpp"
+#include "PersistentQueue.hpp"
+#include "SharedQueueRegistry.hpp"
 #include "Singleton.hpp"
 
 namespace SNJ {
@@ -23,17 +38,141 @@ namespace SNJ {
    public:
     friend class Singleton<LogManager>;
 
-    std::shared_ptr<FastLogger> CreateLogger(std::string_view baseFileName) {
-      std::string logFilePath = generateLogFileName(baseFileName);
-      auto        logger      = std::make_shared<FastLogger>(logFilePath);
+    std::shared_ptr<FastLogger> CreateLogger(std::string_view baseFileName, RotationPolicy rotationPolicy = {}) {
+      auto logger = std::make_shared<FastLogger>(_logsDir, baseFileName, rotationPolicy);
+      logger->SetRotatedCallback([this](std::string rotatedFile) { onFileRotated(std::move(rotatedFile)); });
 
-      // Store the logger as a weak pointer
-      std::lock_guard<std::mutex> lock(_loggerMutex);
-      _loggers.push_back(logger);
+      {
+        // Store the logger as a weak pointer
+        std::lock_guard<std::mutex> lock(_loggerMutex);
+        _loggers.push_back(logger);
+      }
+
+      std::lock_guard<std::mutex> configLock(_mConfigMutex);
+      std::string                 name(baseFileName);
+      _mNamedLoggers[name] = logger;
+      if (auto config = _mConfig.load()) {
+        auto [change, sinks] = buildLoggerConfig(*config, name);
+        logger->Reconfigure(change);
+        _mConfigSinks[name] = std::move(sinks);
+      }
+      return logger;
+    }
 
+    /**
+     * @brief CreateLogger(), keeping the logger alive until the manager is destroyed, so that
+     *        the handle can be passed to the LOG_* macros from any thread without ownership.
+     */
+    LoggerHandle CreateLoggerHandle(std::string_view baseFileName, RotationPolicy rotationPolicy = {}) {
+      auto                        logger = CreateLogger(baseFileName, rotationPolicy);
+      std::lock_guard<std::mutex> lock(_loggerMutex);
+      _mPinnedLoggers.push_back(logger);
       return logger;
     }
 
+    /**
+     * @brief Creates a file sink in the logs directory whose rotated files are handed to the
+     *        compressor like the loggers' own files. Attach it with FastLogger::AddSink().
+     */
+    std::shared_ptr<FileSink> CreateFileSink(std::string_view baseFileName, LogLevel minLevel = LogLevel::DEBUG,
+                                             RotationPolicy rotationPolicy = {},
+                                             RenderFormat   format         = RenderFormat::TEXT) {
+      auto sink = std::make_shared<FileSink>(_logsDir, baseFileName, rotationPolicy, minLevel, format);
+      sink->GetLogFile().SetRotatedCallback(
+          [this](std::string rotatedFile) { onFileRotated(std::move(rotatedFile)); });
+      return sink;
+    }
+
+    /**
+     * @brief Compresses every rotated file in the background according to @p __policy, off the
+     *        consumer's CPU whether logging has started yet or not: the one set with
+     *        SetConsumerCpu(), else, as a best effort, the one the unpinned consumer last ran on.
+     */
+    void EnableCompression(CompressionPolicy __policy) {
+      std::lock_guard<std::mutex> lock(_mCompressorMutex);
+      _mCompressionPolicy = __policy;
+      startCompressor();
+    }
+
+    /**
+     * @brief Pins the consumer thread to @p __cpu, when logging starts or on its next pass if
+     *        it already has. Background compression never runs on this CPU.
+     */
+    void SetConsumerCpu(int __cpu) {
+      _mConsumerCpu.store(__cpu, std::memory_order_relaxed);
+      _mRepinConsumer.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Applies the configuration file at @p __path (see LogConfig) and re-applies it
+     *        whenever the file is written or replaced, from a watcher thread of its own.
+     *
+     * Every load is parsed into an immutable snapshot first and only then applied, so a file
+     * with an error changes nothing; GetConfigError() tells what was wrong. Producers never
+     * see the configuration itself, only the per-logger and per-call-site level bytes it sets.
+     * Loggers created later get their section applied by CreateLogger().
+     * @return false if the file could not be loaded; it is watched regardless.
+     */
+    bool WatchConfig(const std::string& __path) {
+      _mConfigWatcher.reset();
+      bool loaded     = reloadConfig(__path);
+      _mConfigWatcher = std::make_unique<ConfigFileWatcher>(__path, [this, __path]() { reloadConfig(__path); });
+      return loaded;
+    }
+
+    /// Configuration currently applied, nullptr before the first successful load.
+    std::shared_ptr<const LogConfig> GetConfig() const { return _mConfig.load(); }
+
+    /// Why the last load was rejected, empty if it succeeded.
+    std::string GetConfigError() const {
+      std::lock_guard<std::mutex> lock(_mConfigMutex);
+      return _mConfigError;
+    }
+
+    /**
+     * @brief Counters of every logger created by CreateLogger() that is still alive, named
+     *        after its base file name. Loggers served by a logging daemon only show the
+     *        counters of this process.
+     */
+    std::vector<LoggerStats> GetStats() {
+      std::vector<std::pair<std::string, std::shared_ptr<FastLogger>>> loggers;
+      {
+        std::lock_guard<std::mutex> lock(_mConfigMutex);
+        for (const auto& [name, weakLogger] : _mNamedLoggers) {
+          if (auto logger = weakLogger.lock()) loggers.emplace_back(name, std::move(logger));
+        }
+      }
+      std::vector<LoggerStats> stats;
+      for (auto& [name, logger] : loggers) {
+        stats.push_back(logger->GetStats());
+        stats.back()._mName = name;
+      }
+      return stats;
+    }
+
+    /**
+     * @brief Writes the volume profile of every logger that has FastLogger::EnableVolumeProfiler()
+     *        on into its own log. Done automatically when logging stops.
+     */
+    void ReportLogVolume() {
+      std::lock_guard<std::mutex> lock(_mConfigMutex);
+      for (const auto& [name, weakLogger] : _mNamedLoggers) {
+        if (auto logger = weakLogger.lock()) logger->ReportVolume();
+      }
+    }
+
+    /**
+     * @brief Writes GetStats() to @p __path in the Prometheus text format every @p __interval,
+     *        from the consumer thread. The file is replaced atomically, as expected by e.g. the
+     *        node_exporter textfile collector. An empty path stops the dumps.
+     */
+    void EnableMetricsFile(std::string __path, std::chrono::milliseconds __interval = std::chrono::seconds(10)) {
+      std::lock_guard<std::mutex> lock(_mMetricsMutex);
+      _mMetricsPath     = std::move(__path);
+      _mMetricsInterval = __interval;
+      _mNextMetricsDump = {};
+    }
+
     void StartLogging(bool __startAsync = true) {
       if (_mKeepLogging.load(std::memory_order_acquire)) {
         return;  // Logging already started
@@ -48,11 +187,115 @@ namespace SNJ {
       }
     }
 
+    /**
+     * @brief Moves consuming, formatting and writing for every logger created so far into a
+     *        forked daemon process, then starts logging.
+     *
+     * Threads that log from now on get their queue in a shared-memory file under
+     * @p __queueDirectory, announced to the daemon through a SharedQueueRegistry. The
+     * application keeps a consumer thread only to hand over records of threads that logged
+     * before this call, and to serve loggers created after it. The daemon drains everything
+     * and exits when StopLogging() is called or when the application dies, crash included.
+     *
+     * Call at startup, while the calling thread is the only one in the process: a thread
+     * holding a lock (malloc's included) when the daemon is forked would leave it locked there
+     * for good. Compression workers are stopped for the fork and restarted on both sides, but
+     * StartLogging() and WatchConfig() must come after this call, as must any thread of the
+     * application. Call before any shared library is loaded at runtime as well: the daemon
+     * renders records with the formatters of its copy of the address space, and reads StaticStr
+     * arguments in it, so these are copied into records from now on.
+     * @return false if the daemon could not be started, e.g. because other threads were
+     *         running; StartLogging() still works then.
+     */
+    bool StartLoggingDaemon(std::string __queueDirectory = "/dev/shm/fastlogger") {
+      if (_mKeepLogging.load(std::memory_order_acquire) || _mRegistry) {
+        return false;
+      }
+      // Background work would count as threads: wait for the sinks' pre-opens and stop the
+      // compression workers first. The sinks have nothing to resume; the compressor restarts.
+      std::unique_lock<std::mutex>             lock(_loggerMutex);
+      std::vector<std::shared_ptr<FastLogger>> loggers;
+      for (const auto& weakLogger : _loggers) {
+        if (auto logger = weakLogger.lock()) {
+          logger->QuiesceSinks();
+          loggers.push_back(std::move(logger));
+        }
+      }
+      std::unique_lock<std::mutex> compressorLock(_mCompressorMutex);
+      bool                         compress = _mCompressor != nullptr;
+      _mCompressor.reset();  // Finishes the queued files and joins the workers.
+      auto resumeCompression = [this, compress]() {
+        if (compress) startCompressor();
+      };
+      if (countThreads() != 1) {
+        resumeCompression();
+        return false;
+      }
+      SharedQueueRegistry* registry = SharedQueueRegistry::Create();
+      if (!registry) {
+        resumeCompression();
+        return false;
+      }
+
+      std::vector<DaemonLogger> daemonLoggers;
+      for (const auto& logger : loggers) {
+        // Carries records queued in process so far over to the daemon.
+        MessageQueue* forwardQueue = PersistentQueueFile<MessageQueue>::Create(__queueDirectory);
+        int           slot         = -1;
+        if (forwardQueue) {
+          slot = registry->Publish(reinterpret_cast<std::uintptr_t>(logger.get()),
+                                   PersistentQueueFile<MessageQueue>::GetPath(forwardQueue));
+        }
+        if (slot < 0) {
+          if (forwardQueue) PersistentQueueFile<MessageQueue>::Release(forwardQueue);
+          for (auto& daemonLogger : daemonLoggers) {
+            PersistentQueueFile<MessageQueue>::Release(daemonLogger._mForwardQueue);
+          }
+          SharedQueueRegistry::Destroy(registry);
+          resumeCompression();
+          return false;
+        }
+        daemonLoggers.push_back({logger, forwardQueue, slot});
+      }
+
+      pid_t parent = getpid();
+      pid_t pid    = fork();
+      if (pid == 0) {
+        resumeCompression();
+        compressorLock.unlock();
+        runDaemon(*registry, parent, loggers);
+      }
+      resumeCompression();
+      compressorLock.unlock();
+      if (pid < 0) {
+        for (auto& daemonLogger : daemonLoggers) {
+          PersistentQueueFile<MessageQueue>::Release(daemonLogger._mForwardQueue);
+        }
+        SharedQueueRegistry::Destroy(registry);
+        return false;
+      }
+      FastLogCodec<StaticStr>::CopyCharacters(true);
+
+      for (auto& logger : loggers) {
+        logger->ServeFromDaemon(registry, __queueDirectory);
+      }
+      _loggers.clear();
+      _mDaemonLoggers = std::move(daemonLoggers);
+      _mRegistry      = registry;
+      _mDaemonPid     = pid;
+      lock.unlock();
+
+      StartLogging();
+      return true;
+    }
+
     void StopLogging() {
+      _mConfigWatcher.reset();
       _mKeepLogging = false;
       if (_loggingThread.joinable()) {
         _loggingThread.join();
       }
+      stopDaemon();
     }
 
    private:
@@ -65,8 +308,137 @@ namespace SNJ {
       StopLogging();
     }
 
+    /**
+     * @brief Loads @p __path and applies it. Everything the file asks for, sinks included, is
+     *        built before anything changes; each logger then switches over in one step.
+     */
+    bool reloadConfig(const std::string& __path) {
+      std::string error;
+      auto        config = LogConfig::Load(__path, error);
+
+      std::lock_guard<std::mutex> lock(_mConfigMutex);
+      _mConfigError = std::move(error);
+      if (!config) return false;
+
+      struct Pending {
+        std::shared_ptr<FastLogger>           _mLogger;
+        const std::string*                    _mName;
+        FastLogger::Reconfiguration           _mChange;
+        std::vector<std::shared_ptr<LogSink>> _mSinks;
+      };
+      std::vector<Pending> pending;
+      for (auto it = _mNamedLoggers.begin(); it != _mNamedLoggers.end();) {
+        if (auto logger = it->second.lock()) {
+          auto [change, sinks] = buildLoggerConfig(*config, it->first);
+          pending.push_back({std::move(logger), &it->first, std::move(change), std::move(sinks)});
+          ++it;
+        } else {
+          _mConfigSinks.erase(it->first);
+          it = _mNamedLoggers.erase(it);
+        }
+      }
+
+      CallSiteRegistry::ReplaceOverrides(config->_mSiteLevels, config->_mCategoryLevels);
+      for (auto& entry : pending) {
+        entry._mLogger->Reconfigure(entry._mChange);
+        _mConfigSinks[*entry._mName] = std::move(entry._mSinks);
+      }
+      _mConfig.store(config);
+      return true;
+    }
+
+    /**
+     * @brief What @p __config changes for the logger created as @p __name, with the sinks it
+     *        declares. Settings the file leaves out are left as they are; sinks declared by
+     *        the previous load are replaced.
+     */
+    std::pair<FastLogger::Reconfiguration, std::vector<std::shared_ptr<LogSink>>> buildLoggerConfig(
+        const LogConfig& __config, const std::string& __name) {
+      auto                section = __config._mLoggers.find(__name);
+      const LoggerConfig* logger  = section != __config._mLoggers.end() ? &section->second : nullptr;
+
+      FastLogger::Reconfiguration change;
+      change._mLevel       = logger && logger->_mLevel ? logger->_mLevel : __config._mDefaultLevel;
+      change._mFlushPolicy = logger && logger->_mFlushPolicy ? logger->_mFlushPolicy : __config._mFlushPolicy;
+      if (logger) {
+        change._mRotationPolicy = logger->_mRotationPolicy;
+      }
+      if (auto previous = _mConfigSinks.find(__name); previous != _mConfigSinks.end()) {
+        change._mRemovedSinks = previous->second;
+      }
+
+      static const std::vector<SinkConfig>  kNoSinks;
+      std::vector<std::shared_ptr<LogSink>> sinks;
+      for (const auto& sinkConfig : logger ? logger->_mSinks : kNoSinks) {
+        std::shared_ptr<LogSink> sink;
+        switch (sinkConfig._mKind) {
+          case SinkConfig::Kind::STDOUT:
+            sink = std::make_shared<StdoutSink>(sinkConfig._mMinLevel, sinkConfig._mFormat);
+            break;
+          case SinkConfig::Kind::FILE:
+            sink = CreateFileSink(sinkConfig._mTarget, sinkConfig._mMinLevel, {}, sinkConfig._mFormat);
+            break;
+          case SinkConfig::Kind::SOCKET:
+            sink = std::make_shared<UnixSocketSink>(sinkConfig._mTarget, sinkConfig._mMinLevel, sinkConfig._mFormat);
+            break;
+          case SinkConfig::Kind::NUL:
+            sink = std::make_shared<NullSink>(sinkConfig._mMinLevel, sinkConfig._mFormat);
+            break;
+        }
+        sinks.push_back(std::move(sink));
+      }
+      change._mAddedSinks = sinks;
+      return {std::move(change), std::move(sinks)};
+    }
+
+    void onFileRotated(std::string __rotatedFile) {
+      std::lock_guard<std::mutex> lock(_mCompressorMutex);
+      if (_mCompressor) {
+        _mCompressor->Submit(std::move(__rotatedFile));
+      }
+    }
+
+    /// (Re)starts the compressor from _mCompressionPolicy. Requires _mCompressorMutex.
+    void startCompressor() {
+      _mCompressor = std::make_unique<LogCompressor>(_mCompressionPolicy);
+      _mCompressor->SetExcludedCpu(_mConsumerCpu.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Pins the consumer to the configured CPU, if any; without one it is left where the
+     *        scheduler puts it.
+     */
+    void pinConsumerThread() {
+      int cpu = _mConsumerCpu.load(std::memory_order_relaxed);
+      if (cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+      }
+      excludeConsumerCpu();
+    }
+
+    /**
+     * @brief Keeps the compressor off the consumer's CPU: the configured one, or else the one
+     *        the calling consumer runs on now, refreshed every pass since it may migrate.
+     */
+    void excludeConsumerCpu() {
+      int                         cpu = _mConsumerCpu.load(std::memory_order_relaxed);
+      std::lock_guard<std::mutex> lock(_mCompressorMutex);
+      if (_mCompressor) {
+        _mCompressor->SetExcludedCpu(cpu >= 0 ? cpu : sched_getcpu());
+      }
+    }
+
     void LoggingLoop() {
+      pinConsumerThread();
       while (_mKeepLogging.load(std::memory_order_relaxed)) {
+        if (_mRepinConsumer.exchange(false, std::memory_order_acquire)) [[unlikely]] {
+          pinConsumerThread();
+        } else if (_mConsumerCpu.load(std::memory_order_relaxed) < 0) {
+          excludeConsumerCpu();
+        }
         std::lock_guard<std::mutex> lock(_loggerMutex);
 
         // Call ConsumeAndWriteLogs() for active loggers
@@ -75,31 +447,212 @@ namespace SNJ {
             logger->ConsumeAndWriteLogs();
           }
         }
+        forwardToDaemon();
 
         // Remove expired loggers safely using erase-remove idiom
         _loggers.erase(std::remove_if(_loggers.begin(), _loggers.end(),
                                       [](const std::weak_ptr<FastLogger>& logger) { return logger.expired(); }),
                        _loggers.end());
 
+        dumpMetrics(false);
         std::this_thread::sleep_for(std::chrono::milliseconds(100));  // Avoid busy waiting
       }
+
+      // Final pass, so that records logged before StopLogging() are not left in the queues.
+      {
+        std::lock_guard<std::mutex> lock(_loggerMutex);
+        for (const auto& weakLogger : _loggers) {
+          if (auto logger = weakLogger.lock()) {
+            logger->ConsumeAndWriteLogs();
+            logger->FlushPendingRepeats();
+          }
+        }
+        forwardToDaemon();
+      }
+      ReportLogVolume();
+      dumpMetrics(true);
     }
 
-    std::string generateLogFileName(std::string_view baseFileName) {
-      auto        now    = std::chrono::system_clock::now();
-      std::time_t now_c  = std::chrono::system_clock::to_time_t(now);
-      std::tm     now_tm = *std::localtime(&now_c);
+    void dumpMetrics(bool __force) {
+      std::string path;
+      {
+        std::lock_guard<std::mutex> lock(_mMetricsMutex);
+        auto                        now = std::chrono::steady_clock::now();
+        if (_mMetricsPath.empty() || (!__force && now < _mNextMetricsDump)) return;
+        _mNextMetricsDump = now + _mMetricsInterval;
+        path              = _mMetricsPath;
+      }
+
+      std::string output;
+      WritePrometheus(GetStats(), output);
+      std::string temporary = path + ".tmp";
+      {
+        std::ofstream file(temporary, std::ios::trunc);
+        file << output;
+        if (!file) return;
+      }
+      std::rename(temporary.c_str(), path.c_str());
+    }
 
-      std::ostringstream oss;
-      oss << _logsDir << "/" << baseFileName << "_" << std::put_time(&now_tm, "%Y-%m-%d") << ".log";
-      return oss.str();
+    /**
+     * @brief Hands records still queued in process for daemon served loggers over to the daemon.
+     */
+    void forwardToDaemon() {
+      for (auto& daemonLogger : _mDaemonLoggers) {
+        if (auto logger = daemonLogger._mLogger.lock()) {
+          logger->ForwardQueues(*daemonLogger._mForwardQueue);
+        }
+      }
     }
 
-    std::string                            _logsDir;
-    std::atomic<bool>                      _mKeepLogging;
-    std::vector<std::weak_ptr<FastLogger>> _loggers;
-    std::mutex                             _loggerMutex;
-    std::thread                            _loggingThread;
+    void stopDaemon() {
+      if (!_mRegistry) return;
+      {
+        std::lock_guard<std::mutex> lock(_loggerMutex);
+        forwardToDaemon();
+        for (auto& daemonLogger : _mDaemonLoggers) {
+          PersistentQueueFile<MessageQueue>::Release(daemonLogger._mForwardQueue);
+          _mRegistry->Retire(daemonLogger._mSlot);
+        }
+        _mDaemonLoggers.clear();
+      }
+      _mRegistry->RequestStop();
+      // Bounded, so that a daemon stuck for whatever reason cannot hang the application on exit.
+      auto deadline = std::chrono::steady_clock::now() + kDaemonStopTimeout;
+      while (waitpid(_mDaemonPid, nullptr, WNOHANG) == 0) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+          kill(_mDaemonPid, SIGKILL);
+          waitpid(_mDaemonPid, nullptr, 0);
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      // The registry stays mapped: threads that are still alive retire their slots on exit.
+      _mDaemonPid = -1;
+    }
+
+    /**
+     * @brief Threads of this process according to /proc, 0 if that cannot be read.
+     */
+    static int countThreads() {
+      std::ifstream status("/proc/self/status");
+      std::string   line;
+      while (std::getline(status, line)) {
+        if (line.starts_with("Threads:")) return std::atoi(line.c_str() + 8);
+      }
+      return 0;
+    }
+
+    /**
+     * @brief Body of the forked daemon. Only the forking thread exists here, so the parent's
+     *        queues are rebuilt first; the compressor was already restarted by the caller.
+     */
+    [[noreturn]] void runDaemon(SharedQueueRegistry& __registry, pid_t __parent,
+                                const std::vector<std::shared_ptr<FastLogger>>& __loggers) {
+      setsid();  // Out of the terminal's process group, so Ctrl-C does not cut the final drain short.
+      prctl(PR_SET_NAME, "fastlogger-d", 0, 0, 0);
+
+      for (const auto& logger : __loggers) {
+        logger->ResetQueuesAfterFork();
+      }
+      pinConsumerThread();
+
+      auto findLogger = [&__loggers](std::uintptr_t __owner) -> FastLogger* {
+        for (const auto& logger : __loggers) {
+          if (reinterpret_cast<std::uintptr_t>(logger.get()) == __owner) return logger.get();
+        }
+        return nullptr;
+      };
+
+      using SlotState = SharedQueueRegistry::SlotState;
+      std::vector<MessageQueue*> attached(SharedQueueRegistry::kMaxQueues, nullptr);
+      std::vector<SlotState>     states(SharedQueueRegistry::kMaxQueues);
+      while (true) {
+        if (_mConsumerCpu.load(std::memory_order_relaxed) < 0) {
+          excludeConsumerCpu();
+        }
+        bool orphaned = getppid() != __parent;
+        bool stopping = orphaned || __registry.IsStopRequested();
+
+        // States are sampled before consuming: a queue seen retired here has no record left
+        // behind once the pass below is done.
+        for (std::size_t i = 0; i < SharedQueueRegistry::kMaxQueues; ++i) {
+          states[i] = __registry.GetState(i);
+          if ((states[i] == SlotState::ACTIVE || states[i] == SlotState::RETIRED) && !attached[i]) {
+            FastLogger* logger = findLogger(__registry.GetOwner(i));
+            attached[i] = logger ? PersistentQueueFile<MessageQueue>::Open(__registry.GetPath(i)) : nullptr;
+            if (attached[i]) {
+              logger->_mThreadScopedQueueManager->AttachQueue(attached[i]);
+            }
+          }
+        }
+
+        for (const auto& logger : __loggers) {
+          logger->ConsumeAndWriteLogs();
+        }
+
+        for (std::size_t i = 0; i < SharedQueueRegistry::kMaxQueues; ++i) {
+          bool retired = states[i] == SlotState::RETIRED || (orphaned && states[i] == SlotState::ACTIVE);
+          if (!retired) continue;
+          if (attached[i]) {
+            findLogger(__registry.GetOwner(i))->_mThreadScopedQueueManager->DetachQueue(attached[i]);
+            PersistentQueueFile<MessageQueue>::Close(attached[i]);
+            unlink(__registry.GetPath(i));
+            attached[i] = nullptr;
+          }
+          if (states[i] == SlotState::RETIRED) {
+            __registry.Free(i);
+          }
+        }
+
+        if (stopping) {
+          for (const auto& logger : __loggers) {
+            logger->FlushPendingRepeats();
+          }
+          break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      }
+      _exit(0);
+    }
+
+    /**
+     * @brief Logger served by the daemon, with the queue its in-process records are forwarded to.
+     */
+    struct DaemonLogger {
+      std::weak_ptr<FastLogger> _mLogger;
+      MessageQueue*             _mForwardQueue;
+      int                       _mSlot;
+    };
+
+    std::string                              _logsDir;
+    std::atomic<bool>                        _mKeepLogging;
+    std::vector<std::weak_ptr<FastLogger>>   _loggers;
+    std::vector<std::shared_ptr<FastLogger>> _mPinnedLoggers;  ///< Loggers behind CreateLoggerHandle().
+    std::mutex                               _loggerMutex;
+    std::thread                              _loggingThread;
+    std::atomic<int>                         _mConsumerCpu{-1};
+    std::atomic<bool>                        _mRepinConsumer{false};  ///< CPU set after logging started.
+    std::mutex                               _mCompressorMutex;
+    std::unique_ptr<LogCompressor>           _mCompressor;
+    CompressionPolicy                        _mCompressionPolicy;
+    SharedQueueRegistry*                     _mRegistry{nullptr};  ///< Set while a logging daemon serves loggers.
+    pid_t                                    _mDaemonPid{-1};
+    std::vector<DaemonLogger>                _mDaemonLoggers;
+
+    inline static constexpr std::chrono::seconds kDaemonStopTimeout{10};  ///< Final drain, then SIGKILL.
+
+    mutable std::mutex                                            _mConfigMutex;  ///< Serialises loads.
+    std::atomic<std::shared_ptr<const LogConfig>>                 _mConfig;
+    std::string                                                   _mConfigError;
+    std::map<std::string, std::weak_ptr<FastLogger>>              _mNamedLoggers;
+    std::map<std::string, std::vector<std::shared_ptr<LogSink>>>  _mConfigSinks;  ///< Declared by the config.
+    std::unique_ptr<ConfigFileWatcher>                            _mConfigWatcher;
+
+    std::mutex                            _mMetricsMutex;
+    std::string                           _mMetricsPath;  ///< Prometheus text file, empty if disabled.
+    std::chrono::milliseconds             _mMetricsInterval{std::chrono::seconds(10)};
+    std::chrono::steady_clock::time_point _mNextMetricsDump;
   };
 }  // namespace SNJ
 
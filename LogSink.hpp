@@ -0,0 +1,237 @@
+#ifndef LOGSINK_HPP
+#define LOGSINK_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "LogLevel.hpp"
+#include "NonCopyMovable.hpp"
+#include "RotatingLogFile.hpp"
+
+namespace SNJ {
+
+  /**
+   * @brief Output format a sink wants its records rendered in. The consumer renders each
+   *        record at most once per distinct format, however many sinks share it.
+   */
+  enum class RenderFormat : std::uint8_t {
+    TEXT,   ///< `[timestamp] [LEVEL] message` lines.
+    JSON,   ///< One JSON object per line (JSON Lines).
+    LOGFMT  ///< `key=value` pairs per line.
+  };
+
+  inline static constexpr std::size_t kRenderFormatCount = 3;
+
+  /**
+   * @brief When the consumer flushes the sinks of a logger.
+   */
+  enum class FlushPolicy : std::uint8_t {
+    EVERY_RECORD,  ///< After each record; nothing stays buffered between passes.
+    EVERY_PASS     ///< Once at the end of each consumer pass.
+  };
+
+  /**
+   * @class LogSink
+   * @brief Destination for rendered records. Only ever called from the consumer thread.
+   */
+  class LogSink {
+   public:
+    LogSink(LogLevel __minLevel = LogLevel::DEBUG, RenderFormat __format = RenderFormat::TEXT)
+        : _mMinLevel(__minLevel), _mFormat(__format) {}
+
+    MAKE_NON_COPYABLE(LogSink);
+    MAKE_NON_MOVABLE(LogSink);
+
+    virtual ~LogSink() noexcept = default;
+
+    /**
+     * @brief Writes one rendered record, including its trailing newline.
+     */
+    virtual void Write(const char* __data, std::size_t __size) = 0;
+
+    virtual void Flush() {}
+
+    /**
+     * @brief Called once at the start of every consumer pass, before any Write.
+     */
+    virtual void BeginPass() {}
+
+    /// Waits for background work started by the sink, if any.
+    virtual void Quiesce() {}
+
+    bool Accepts(LogLevel __logLevel) const { return __logLevel >= _mMinLevel.load(std::memory_order_relaxed); }
+
+    void SetMinLevel(LogLevel __logLevel) { _mMinLevel.store(__logLevel, std::memory_order_relaxed); }
+
+    RenderFormat GetFormat() const { return _mFormat; }
+
+   private:
+    std::atomic<LogLevel> _mMinLevel;
+    RenderFormat          _mFormat;
+  };
+
+  /**
+   * @brief Writes to a (optionally rotating) log file.
+   */
+  class FileSink : public LogSink {
+   public:
+    FileSink(std::string_view __filePath, LogLevel __minLevel = LogLevel::DEBUG,
+             RenderFormat __format = RenderFormat::TEXT)
+        : LogSink(__minLevel, __format), _mLogFile(__filePath) {}
+
+    FileSink(std::string_view __logsDir, std::string_view __baseFileName, RotationPolicy __rotationPolicy,
+             LogLevel __minLevel = LogLevel::DEBUG, RenderFormat __format = RenderFormat::TEXT)
+        : LogSink(__minLevel, __format), _mLogFile(__logsDir, __baseFileName, __rotationPolicy) {}
+
+    void Write(const char* __data, std::size_t __size) override { _mLogFile.Write(__data, __size); }
+
+    void Flush() override { _mLogFile.Flush(); }
+
+    void BeginPass() override { _mLogFile.RotateIfDue(); }
+
+    void Quiesce() override { _mLogFile.WaitForPendingOpen(); }
+
+    RotatingLogFile& GetLogFile() { return _mLogFile; }
+
+   private:
+    RotatingLogFile _mLogFile;
+  };
+
+  class StdoutSink : public LogSink {
+   public:
+    using LogSink::LogSink;
+
+    void Write(const char* __data, std::size_t __size) override { std::fwrite(__data, 1, __size, stdout); }
+
+    void Flush() override { std::fflush(stdout); }
+  };
+
+  /**
+   * @brief Keeps the last @p __capacity records in memory, e.g. for tests or an admin endpoint.
+   */
+  class RingSink : public LogSink {
+   public:
+    RingSink(std::size_t __capacity, LogLevel __minLevel = LogLevel::DEBUG,
+             RenderFormat __format = RenderFormat::TEXT)
+        : LogSink(__minLevel, __format), _mLines(__capacity) {}
+
+    void Write(const char* __data, std::size_t __size) override {
+      if (_mLines.empty()) return;
+      std::lock_guard<std::mutex> lock(_mLock);
+      _mLines[_mNext % _mLines.size()].assign(__data, __size);
+      ++_mNext;
+    }
+
+    /**
+     * @brief Copy of the retained records, oldest first. Safe to call from any thread.
+     */
+    std::vector<std::string> GetLines() const {
+      std::lock_guard<std::mutex> lock(_mLock);
+      std::vector<std::string>    lines;
+      std::size_t                 count = std::min(_mNext, _mLines.size());
+      lines.reserve(count);
+      for (std::size_t i = _mNext - count; i < _mNext; ++i) {
+        lines.push_back(_mLines[i % _mLines.size()]);
+      }
+      return lines;
+    }
+
+   private:
+    mutable std::mutex       _mLock;
+    std::vector<std::string> _mLines;
+    std::size_t              _mNext{0};  ///< Total records written; next slot is `_mNext % capacity`.
+  };
+
+  /**
+   * @brief Sends each record as one datagram to a Unix-domain socket.
+   *
+   * Sends never block: records are dropped while the receiver is absent or not keeping up,
+   * and reconnection is retried at most once per second.
+   */
+  class UnixSocketSink : public LogSink {
+   public:
+    UnixSocketSink(std::string_view __socketPath, LogLevel __minLevel = LogLevel::DEBUG,
+                   RenderFormat __format = RenderFormat::TEXT)
+        : LogSink(__minLevel, __format), _mSocketPath(__socketPath) {
+      connectSocket();
+    }
+
+    ~UnixSocketSink() noexcept override {
+      if (_mSocket >= 0) {
+        close(_mSocket);
+      }
+    }
+
+    void Write(const char* __data, std::size_t __size) override {
+      if (_mSocket < 0 && !reconnect()) {
+        return;
+      }
+      if (send(_mSocket, __data, __size, MSG_DONTWAIT | MSG_NOSIGNAL) < 0 && errno != EAGAIN &&
+          errno != EWOULDBLOCK) {
+        close(_mSocket);
+        _mSocket = -1;
+      }
+    }
+
+   private:
+    bool reconnect() {
+      auto now = std::chrono::steady_clock::now();
+      if (now - _mLastConnectAttempt < std::chrono::seconds(1)) {
+        return false;
+      }
+      return connectSocket();
+    }
+
+    bool connectSocket() {
+      _mLastConnectAttempt = std::chrono::steady_clock::now();
+
+      sockaddr_un address{};
+      address.sun_family = AF_UNIX;
+      if (_mSocketPath.size() >= sizeof(address.sun_path)) {
+        return false;
+      }
+      std::memcpy(address.sun_path, _mSocketPath.c_str(), _mSocketPath.size() + 1);
+
+      int fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+      if (fd < 0) {
+        return false;
+      }
+      if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return false;
+      }
+      _mSocket = fd;
+      return true;
+    }
+
+    std::string                           _mSocketPath;
+    int                                   _mSocket{-1};
+    std::chrono::steady_clock::time_point _mLastConnectAttempt;
+  };
+
+  /**
+   * @brief Discards everything. Useful to measure the producer and formatting cost alone.
+   */
+  class NullSink : public LogSink {
+   public:
+    using LogSink::LogSink;
+
+    void Write(const char*, std::size_t) override {}
+  };
+}  // namespace SNJ
+
+#endif  // LOGSINK_HPP
@@ -0,0 +1,242 @@
+#ifndef LOGSTATS_HPP
+#define LOGSTATS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace SNJ {
+
+  /**
+   * @brief Health of one producer thread's queue.
+   */
+  struct QueueStats {
+    std::int32_t  _mThreadId{0};       ///< Kernel tid; 0 for the totals of threads that exited.
+    std::size_t   _mDepth{0};          ///< Records waiting right now.
+    std::size_t   _mHighWaterMark{0};  ///< Deepest the queue has been when the consumer reached it.
+    std::uint64_t _mEnqueueSpins{0};   ///< Enqueues that found the queue full and waited.
+    std::uint64_t _mDrops{0};          ///< Records discarded under OverflowPolicy::DROP.
+  };
+
+  /**
+   * @class LatencyHistogram
+   * @brief Log-linear histogram of durations in nanoseconds: four buckets per power of two,
+   *        so a reported percentile is at most 25% above the true value. Not thread-safe.
+   */
+  class LatencyHistogram {
+   public:
+    inline static constexpr std::size_t kSubBuckets = 4;
+    inline static constexpr std::size_t kBuckets    = 64 * kSubBuckets;
+
+    void Record(std::uint64_t __ns) {
+      ++_mCounts[bucketOf(__ns)];
+      ++_mCount;
+      _mSum += __ns;
+      _mMax = std::max(_mMax, __ns);
+    }
+
+    void Reset() { *this = LatencyHistogram{}; }
+
+    std::uint64_t GetCount() const { return _mCount; }
+
+    std::uint64_t GetSum() const { return _mSum; }
+
+    std::uint64_t GetMax() const { return _mMax; }
+
+    /**
+     * @brief Upper bound of the bucket holding the record at @p __quantile (0..1), capped at
+     *        the largest value recorded. 0 if nothing was recorded.
+     */
+    std::uint64_t GetPercentile(double __quantile) const {
+      if (_mCount == 0) return 0;
+      auto          rank = static_cast<std::uint64_t>(std::ceil(__quantile * static_cast<double>(_mCount)));
+      std::uint64_t seen = 0;
+      for (std::size_t bucket = 0; bucket < kBuckets; ++bucket) {
+        seen += _mCounts[bucket];
+        if (seen >= std::max<std::uint64_t>(rank, 1)) return std::min(upperBound(bucket), _mMax);
+      }
+      return _mMax;
+    }
+
+   private:
+    static std::size_t bucketOf(std::uint64_t __ns) {
+      if (__ns < kSubBuckets) return static_cast<std::size_t>(__ns);
+      std::size_t msb = 63 - static_cast<std::size_t>(__builtin_clzll(__ns));
+      return (msb - 1) * kSubBuckets + static_cast<std::size_t>((__ns >> (msb - 2)) & (kSubBuckets - 1));
+    }
+
+    static std::uint64_t upperBound(std::size_t __bucket) {
+      if (__bucket < kSubBuckets) return __bucket;
+      std::size_t   shift = __bucket / kSubBuckets - 1;
+      std::uint64_t next  = kSubBuckets + __bucket % kSubBuckets + 1;
+      return shift >= 62 && next == 2 * kSubBuckets ? ~std::uint64_t{0} : (next << shift) - 1;
+    }
+
+    std::uint64_t _mCounts[kBuckets] = {};
+    std::uint64_t _mCount{0};
+    std::uint64_t _mSum{0};
+    std::uint64_t _mMax{0};
+  };
+
+  /**
+   * @brief Snapshot of a logger's counters, see FastLogger::GetStats().
+   */
+  struct LoggerStats {
+    std::string             _mName;
+    std::uint64_t           _mRecordsWritten{0};  ///< Lines handed to sinks, consumer generated ones included.
+    std::uint64_t           _mBytesWritten{0};    ///< Summed over sinks.
+    std::uint64_t           _mPasses{0};          ///< Consumer passes over the queues.
+    std::uint64_t           _mFormatNs{0};        ///< Total time spent rendering records.
+    std::uint64_t           _mWriteNs{0};         ///< Total time spent in sink Write() and Flush().
+    std::uint64_t           _mLastPassFormatNs{0};
+    std::uint64_t           _mLastPassWriteNs{0};
+    std::uint64_t           _mConsumerLagNs{0};   ///< Start of the previous pass to end of the last one.
+    LatencyHistogram        _mWriteLatency;       ///< Enqueue to sink write, if latency tracking is on.
+    std::vector<QueueStats> _mQueues;
+  };
+
+  /**
+   * @brief Records and rendered bytes attributed to one call site or one producer thread.
+   */
+  struct LogVolume {
+    std::string   _mSite;         ///< `site:format` of the statement; empty for a thread.
+    std::int32_t  _mThreadId{0};  ///< Producer thread; 0 for a call site.
+    std::uint64_t _mRecords{0};
+    std::uint64_t _mBytes{0};  ///< Summed over sinks.
+  };
+
+  /**
+   * @brief Log volume since the profiler was enabled, see FastLogger::GetVolumeProfile().
+   */
+  struct VolumeProfile {
+    std::uint64_t          _mRecords{0};
+    std::uint64_t          _mBytes{0};
+    std::size_t            _mSiteCount{0};  ///< Call sites seen, including those not in _mSites.
+    std::vector<LogVolume> _mSites;         ///< Heaviest first, by bytes.
+    std::vector<LogVolume> _mThreads;       ///< Heaviest first, by bytes.
+  };
+
+  inline std::string NanosToSeconds(std::uint64_t __ns) { return std::to_string(static_cast<double>(__ns) * 1e-9); }
+
+  /**
+   * @brief Renders @p __stats in the Prometheus text exposition format.
+   */
+  inline void WritePrometheus(const std::vector<LoggerStats>& __stats, std::string& __output) {
+    auto label = [&__output](std::string_view __value) {
+      for (char c : __value) {
+        if (c == '\\' || c == '"') {
+          __output += '\\';
+          __output += c;
+        } else if (c == '\n') {
+          __output += "\\n";
+        } else {
+          __output += c;
+        }
+      }
+    };
+    auto header = [&__output](const char* __name, const char* __type, const char* __help) {
+      __output += "# HELP ";
+      __output += __name;
+      __output += ' ';
+      __output += __help;
+      __output += "\n# TYPE ";
+      __output += __name;
+      __output += ' ';
+      __output += __type;
+      __output += '\n';
+    };
+    auto sample = [&__output, &label](const char* __name, const LoggerStats& __logger, const QueueStats* __queue,
+                                      std::string_view __value) {
+      __output += __name;
+      __output += "{logger=\"";
+      label(__logger._mName);
+      if (__queue) {
+        __output += "\",tid=\"";
+        __output += __queue->_mThreadId ? std::to_string(__queue->_mThreadId) : "exited";
+      }
+      __output += "\"} ";
+      __output += __value;
+      __output += '\n';
+    };
+
+    struct LoggerMetric {
+      const char* _mName;
+      const char* _mType;
+      const char* _mHelp;
+      std::string (*_mValue)(const LoggerStats&);
+    };
+    static const LoggerMetric kLoggerMetrics[] = {
+        {"fastlogger_records_written_total", "counter", "Lines handed to sinks.",
+         [](const LoggerStats& __s) { return std::to_string(__s._mRecordsWritten); }},
+        {"fastlogger_bytes_written_total", "counter", "Bytes handed to sinks, summed over sinks.",
+         [](const LoggerStats& __s) { return std::to_string(__s._mBytesWritten); }},
+        {"fastlogger_consumer_passes_total", "counter", "Consumer passes over the queues.",
+         [](const LoggerStats& __s) { return std::to_string(__s._mPasses); }},
+        {"fastlogger_format_seconds_total", "counter", "Time the consumer spent rendering records.",
+         [](const LoggerStats& __s) { return NanosToSeconds(__s._mFormatNs); }},
+        {"fastlogger_write_seconds_total", "counter", "Time the consumer spent writing and flushing sinks.",
+         [](const LoggerStats& __s) { return NanosToSeconds(__s._mWriteNs); }},
+        {"fastlogger_last_pass_format_seconds", "gauge", "Rendering time of the last consumer pass.",
+         [](const LoggerStats& __s) { return NanosToSeconds(__s._mLastPassFormatNs); }},
+        {"fastlogger_last_pass_write_seconds", "gauge", "Writing time of the last consumer pass.",
+         [](const LoggerStats& __s) { return NanosToSeconds(__s._mLastPassWriteNs); }},
+        {"fastlogger_consumer_lag_seconds", "gauge", "Longest a record can have waited for the last pass.",
+         [](const LoggerStats& __s) { return NanosToSeconds(__s._mConsumerLagNs); }},
+    };
+
+    for (const LoggerMetric& metric : kLoggerMetrics) {
+      header(metric._mName, metric._mType, metric._mHelp);
+      for (const LoggerStats& logger : __stats) {
+        sample(metric._mName, logger, nullptr, metric._mValue(logger));
+      }
+    }
+
+    header("fastlogger_write_latency_seconds", "summary", "Time from enqueue to sink write.");
+    for (const LoggerStats& logger : __stats) {
+      const LatencyHistogram& latency = logger._mWriteLatency;
+      if (latency.GetCount() == 0) continue;
+      for (auto [quantileLabel, quantile] : {std::pair{"0.5", 0.5}, {"0.99", 0.99}, {"0.999", 0.999}, {"1", 1.0}}) {
+        __output += "fastlogger_write_latency_seconds{logger=\"";
+        label(logger._mName);
+        __output += "\",quantile=\"";
+        __output += quantileLabel;
+        __output += "\"} ";
+        __output += NanosToSeconds(latency.GetPercentile(quantile));
+        __output += '\n';
+      }
+      sample("fastlogger_write_latency_seconds_sum", logger, nullptr, NanosToSeconds(latency.GetSum()));
+      sample("fastlogger_write_latency_seconds_count", logger, nullptr, std::to_string(latency.GetCount()));
+    }
+
+    struct QueueMetric {
+      const char* _mName;
+      const char* _mType;
+      const char* _mHelp;
+      std::uint64_t (*_mValue)(const QueueStats&);
+    };
+    static const QueueMetric kQueueMetrics[] = {
+        {"fastlogger_queue_depth", "gauge", "Records waiting in a producer thread's queue.",
+         [](const QueueStats& __q) -> std::uint64_t { return __q._mDepth; }},
+        {"fastlogger_queue_high_water_mark", "gauge", "Deepest a producer thread's queue has been.",
+         [](const QueueStats& __q) -> std::uint64_t { return __q._mHighWaterMark; }},
+        {"fastlogger_enqueue_spins_total", "counter", "Enqueues that found the queue full and waited.",
+         [](const QueueStats& __q) { return __q._mEnqueueSpins; }},
+        {"fastlogger_dropped_records_total", "counter", "Records dropped because the queue was full.",
+         [](const QueueStats& __q) { return __q._mDrops; }},
+    };
+    for (const QueueMetric& metric : kQueueMetrics) {
+      header(metric._mName, metric._mType, metric._mHelp);
+      for (const LoggerStats& logger : __stats) {
+        for (const QueueStats& queue : logger._mQueues) {
+          sample(metric._mName, logger, &queue, std::to_string(metric._mValue(queue)));
+        }
+      }
+    }
+  }
+}  // namespace SNJ
+
+#endif  // LOGSTATS_HPP
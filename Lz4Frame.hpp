@@ -0,0 +1,187 @@
+#ifndef LZ4FRAME_HPP
+#define LZ4FRAME_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace SNJ {
+
+  /**
+   * @brief Minimal, dependency free writer for the LZ4 frame format.
+   *
+   * Uses a single-pass greedy matcher over independent 64KB blocks. The ratio is below the
+   * reference implementation but the output is a standard `.lz4` frame readable by `lz4 -d`.
+   */
+  class Lz4FrameWriter {
+   public:
+    inline static constexpr std::size_t kBlockSize = 64 * 1024;
+
+    /**
+     * @brief Compresses everything readable from @p __in into @p __out.
+     * @return false if either stream failed.
+     */
+    static bool Compress(std::istream& __in, std::ostream& __out) {
+      writeFrameHeader(__out);
+
+      std::vector<char>         block(kBlockSize);
+      std::vector<std::uint8_t> compressed(kBlockSize + kBlockSize / 255 + 16);
+      while (__in) {
+        __in.read(block.data(), block.size());
+        std::size_t size = static_cast<std::size_t>(__in.gcount());
+        if (size == 0) break;
+
+        std::size_t compressedSize =
+            CompressBlock(reinterpret_cast<const std::uint8_t*>(block.data()), size, compressed.data());
+        if (compressedSize < size) {
+          writeLE32(__out, static_cast<std::uint32_t>(compressedSize));
+          __out.write(reinterpret_cast<const char*>(compressed.data()), compressedSize);
+        } else {
+          // Incompressible block, stored raw as flagged by the high bit of the size.
+          writeLE32(__out, static_cast<std::uint32_t>(size) | 0x80000000U);
+          __out.write(block.data(), size);
+        }
+      }
+
+      writeLE32(__out, 0);  // EndMark
+      return !__in.bad() && __out.good();
+    }
+
+    /**
+     * @brief Compresses one block into LZ4 block format.
+     * @param __dst must hold at least `__size + __size / 255 + 16` bytes.
+     * @return number of bytes written to @p __dst.
+     */
+    static std::size_t CompressBlock(const std::uint8_t* __src, std::size_t __size, std::uint8_t* __dst) {
+      constexpr std::size_t kMinMatch  = 4;
+      constexpr std::size_t kMFLimit   = 12;  // Last match must start this far before the end.
+      constexpr std::size_t kLastLits  = 5;   // Trailing bytes that are always literals.
+      constexpr std::size_t kMaxOffset = 65535;
+      constexpr unsigned    kHashLog   = 12;
+
+      std::uint8_t*       op     = __dst;
+      const std::uint8_t* anchor = __src;
+
+      if (__size > kMFLimit) {
+        std::uint32_t       table[1U << kHashLog] = {};
+        const std::uint8_t* ip                    = __src;
+        const std::uint8_t* mflimit               = __src + __size - kMFLimit;
+        const std::uint8_t* matchlimit            = __src + __size - kLastLits;
+
+        while (ip < mflimit) {
+          std::uint32_t       sequence = read32(ip);
+          std::uint32_t       hash     = (sequence * 2654435761U) >> (32 - kHashLog);
+          const std::uint8_t* ref      = __src + table[hash];
+          table[hash]                  = static_cast<std::uint32_t>(ip - __src);
+
+          if (ref >= ip || static_cast<std::size_t>(ip - ref) > kMaxOffset || read32(ref) != sequence) {
+            ++ip;
+            continue;
+          }
+
+          const std::uint8_t* matchEnd = ip + kMinMatch;
+          const std::uint8_t* refEnd   = ref + kMinMatch;
+          while (matchEnd < matchlimit && *matchEnd == *refEnd) {
+            ++matchEnd;
+            ++refEnd;
+          }
+
+          std::uint8_t* token;
+          op    = writeLiterals(op, token, anchor, static_cast<std::size_t>(ip - anchor));
+          *op++ = static_cast<std::uint8_t>((ip - ref) & 0xFF);
+          *op++ = static_cast<std::uint8_t>((ip - ref) >> 8);
+          op    = writeMatchLength(op, token, static_cast<std::size_t>(matchEnd - ip) - kMinMatch);
+
+          ip     = matchEnd;
+          anchor = ip;
+        }
+      }
+
+      std::uint8_t* token;
+      op = writeLiterals(op, token, anchor, static_cast<std::size_t>(__src + __size - anchor));
+      return static_cast<std::size_t>(op - __dst);
+    }
+
+   private:
+    static std::uint32_t read32(const std::uint8_t* __ptr) {
+      std::uint32_t value;
+      std::memcpy(&value, __ptr, sizeof(value));
+      return value;
+    }
+
+    /**
+     * @brief Emits the token, literal length and literals. The match length nibble of the
+     *        token is filled in by writeMatchLength.
+     */
+    static std::uint8_t* writeLiterals(std::uint8_t* __op, std::uint8_t*& __token, const std::uint8_t* __literals,
+                                       std::size_t __length) {
+      __token = __op++;
+      if (__length >= 15) {
+        *__token = 15 << 4;
+        std::size_t remaining = __length - 15;
+        for (; remaining >= 255; remaining -= 255) *__op++ = 255;
+        *__op++ = static_cast<std::uint8_t>(remaining);
+      } else {
+        *__token = static_cast<std::uint8_t>(__length << 4);
+      }
+      std::memcpy(__op, __literals, __length);
+      return __op + __length;
+    }
+
+    static std::uint8_t* writeMatchLength(std::uint8_t* __op, std::uint8_t* __token, std::size_t __length) {
+      if (__length >= 15) {
+        *__token |= 15;
+        std::size_t remaining = __length - 15;
+        for (; remaining >= 255; remaining -= 255) *__op++ = 255;
+        *__op++ = static_cast<std::uint8_t>(remaining);
+      } else {
+        *__token |= static_cast<std::uint8_t>(__length);
+      }
+      return __op;
+    }
+
+    static void writeLE32(std::ostream& __out, std::uint32_t __value) {
+      char bytes[4] = {static_cast<char>(__value), static_cast<char>(__value >> 8), static_cast<char>(__value >> 16),
+                       static_cast<char>(__value >> 24)};
+      __out.write(bytes, sizeof(bytes));
+    }
+
+    static void writeFrameHeader(std::ostream& __out) {
+      writeLE32(__out, 0x184D2204U);          // Magic number
+      std::uint8_t descriptor[2] = {0x60,     // Version 01, independent blocks, no checksums
+                                    0x40};    // 64KB max block size
+      std::uint8_t headerChecksum = static_cast<std::uint8_t>(xxh32Small(descriptor, sizeof(descriptor)) >> 8);
+      __out.write(reinterpret_cast<const char*>(descriptor), sizeof(descriptor));
+      __out.put(static_cast<char>(headerChecksum));
+    }
+
+    /// XXH32 with seed 0, only valid for inputs shorter than 16 bytes (the frame descriptor).
+    static std::uint32_t xxh32Small(const std::uint8_t* __data, std::size_t __size) {
+      constexpr std::uint32_t kPrime1 = 2654435761U, kPrime2 = 2246822519U, kPrime3 = 3266489917U,
+                              kPrime4 = 668265263U, kPrime5 = 374761393U;
+      auto rotl = [](std::uint32_t __x, int __r) { return (__x << __r) | (__x >> (32 - __r)); };
+
+      std::uint32_t hash = kPrime5 + static_cast<std::uint32_t>(__size);
+      std::size_t   i    = 0;
+      for (; i + 4 <= __size; i += 4) {
+        hash += read32(__data + i) * kPrime3;
+        hash  = rotl(hash, 17) * kPrime4;
+      }
+      for (; i < __size; ++i) {
+        hash += __data[i] * kPrime5;
+        hash  = rotl(hash, 11) * kPrime1;
+      }
+      hash ^= hash >> 15;
+      hash *= kPrime2;
+      hash ^= hash >> 13;
+      hash *= kPrime3;
+      hash ^= hash >> 16;
+      return hash;
+    }
+  };
+}  // namespace SNJ
+
+#endif  // LZ4FRAME_HPP
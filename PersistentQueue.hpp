@@ -0,0 +1,247 @@
+#ifndef PERSISTENTQUEUE_HPP
+#define PERSISTENTQUEUE_HPP
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <new>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace SNJ {
+
+  /**
+   * @brief Header in the first page of a queue file. The queue object itself follows at
+   *        kPersistentQueueOffset and is used in place by producer and consumer.
+   */
+  struct PersistentQueueHeader {
+    char           _mMagic[8];   ///< kPersistentQueueMagic
+    std::uint32_t  _mQueueSize;  ///< sizeof the queue object, guards against layout changes.
+    std::int32_t   _mPid;
+    std::int32_t   _mTid;
+    std::uintptr_t _mAnchor;     ///< Runtime address of PersistentQueueAnchor in the writer.
+    std::uint64_t  _mExeSize;    ///< Identity of the executable that wrote the file.
+    std::int64_t   _mExeMtime;
+    char           _mPath[1024];  ///< Own path, to unlink it on release.
+  };
+
+  inline static constexpr char        kPersistentQueueMagic[8] = "SNJFLQ1";
+  inline static constexpr std::size_t kPersistentQueueOffset   = 4096;
+
+  /**
+   * @brief Function whose address relocates code/data pointers (e.g. formatter vtables) found
+   *        in a queue file written by a previous run of the same executable.
+   */
+  inline void PersistentQueueAnchor() {}
+
+  /**
+   * @class PersistentQueueFile
+   * @brief Places a queue object in a MAP_SHARED file mapping so that records survive SIGKILL
+   *        or the OOM killer: the kernel keeps the dirty pages and writes them back on its own.
+   *
+   * The producer and consumer use the mapped queue exactly like a heap allocated one, so the
+   * hot path is unchanged. The file is unlinked when the queue is released empty; anything left
+   * behind in the directory holds records a process did not get to write.
+   */
+  template <class TQueue>
+  class PersistentQueueFile {
+   public:
+    inline static constexpr const char* kExtension = ".flq";
+
+    /**
+     * @brief Creates `<dir>/<pid>-<tid>-<n>.flq` and constructs an empty queue in it.
+     * @return nullptr if the file could not be created or mapped.
+     */
+    static TQueue* Create(const std::string& __directory) {
+      std::error_code ec;
+      std::filesystem::create_directories(__directory, ec);
+
+      pid_t       pid  = getpid();
+      pid_t       tid  = static_cast<pid_t>(syscall(SYS_gettid));
+      std::string path = __directory + "/" + std::to_string(pid) + "-" + std::to_string(tid) + "-" +
+                         std::to_string(sSequence.fetch_add(1, std::memory_order_relaxed)) + kExtension;
+      if (path.size() >= sizeof(PersistentQueueHeader::_mPath)) return nullptr;
+
+      int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+      if (fd < 0) return nullptr;
+      if (ftruncate(fd, static_cast<off_t>(kMappingSize)) != 0) {
+        close(fd);
+        unlink(path.c_str());
+        return nullptr;
+      }
+      void* mapping = mmap(nullptr, kMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+      if (mapping == MAP_FAILED) {
+        unlink(path.c_str());
+        return nullptr;
+      }
+
+      auto* header = new (mapping) PersistentQueueHeader{};
+      memcpy(header->_mMagic, kPersistentQueueMagic, sizeof(header->_mMagic));
+      header->_mQueueSize = static_cast<std::uint32_t>(sizeof(TQueue));
+      header->_mPid       = pid;
+      header->_mTid       = tid;
+      header->_mAnchor    = reinterpret_cast<std::uintptr_t>(&PersistentQueueAnchor);
+      executableIdentity(header->_mExeSize, header->_mExeMtime);
+      memcpy(header->_mPath, path.c_str(), path.size() + 1);
+
+      return new (static_cast<char*>(mapping) + kPersistentQueueOffset) TQueue();
+    }
+
+    /**
+     * @brief Unmaps a queue returned by Create(). Its file is removed unless records are still
+     *        queued, in which case it is left for Recover() once this process has exited.
+     */
+    static void Release(TQueue* __queue) {
+      char* mapping = reinterpret_cast<char*>(__queue) - kPersistentQueueOffset;
+      auto* header  = reinterpret_cast<PersistentQueueHeader*>(mapping);
+      if (__queue->IsEmpty()) {
+        unlink(header->_mPath);
+      }
+      __queue->~TQueue();
+      munmap(mapping, kMappingSize);
+    }
+
+    /**
+     * @brief Maps the queue of an existing file, e.g. one created by another process.
+     *        Release the mapping with Close().
+     * @return nullptr if the file does not exist or is not a queue file of this layout.
+     */
+    static TQueue* Open(const char* __path) {
+      void* mapping = mapFile(__path);
+      if (!mapping) return nullptr;
+      auto* header = static_cast<PersistentQueueHeader*>(mapping);
+      if (memcmp(header->_mMagic, kPersistentQueueMagic, sizeof(header->_mMagic)) != 0 ||
+          header->_mQueueSize != sizeof(TQueue)) {
+        munmap(mapping, kMappingSize);
+        return nullptr;
+      }
+      return reinterpret_cast<TQueue*>(static_cast<char*>(mapping) + kPersistentQueueOffset);
+    }
+
+    /**
+     * @brief Unmaps a queue returned by Open(), leaving the file alone.
+     */
+    static void Close(TQueue* __queue) {
+      munmap(reinterpret_cast<char*>(__queue) - kPersistentQueueOffset, kMappingSize);
+    }
+
+    /**
+     * @brief Path of the file backing a queue returned by Create() or Open().
+     */
+    static const char* GetPath(const TQueue* __queue) { return header(__queue)._mPath; }
+
+    /**
+     * @brief Kernel tid of the thread that created the queue.
+     */
+    static std::int32_t GetThreadId(const TQueue* __queue) { return header(__queue)._mTid; }
+
+    /**
+     * @brief Replays queue files left behind in @p __directory by dead processes.
+     *
+     * @p __callback receives each unconsumed record together with the pointer delta to apply to
+     * code/data addresses it contains. Files written by a different executable cannot be
+     * relocated and are skipped, as are files of processes that are still alive. Replayed files
+     * are removed.
+     * @return number of records replayed.
+     */
+    template <class TRecord, class TCallback>
+    static std::size_t Recover(const std::string& __directory, TCallback __callback) {
+      std::size_t     replayed = 0;
+      std::error_code ec;
+      for (const auto& entry : std::filesystem::directory_iterator(__directory, ec)) {
+        if (entry.path().extension() != kExtension) continue;
+        replayed += recoverFile<TRecord>(entry.path().string(), __callback);
+      }
+      return replayed;
+    }
+
+   private:
+    inline static constexpr std::size_t kMappingSize =
+        kPersistentQueueOffset + ((sizeof(TQueue) + kPersistentQueueOffset - 1) & ~(kPersistentQueueOffset - 1));
+
+    inline static std::atomic<std::uint32_t> sSequence{0};  ///< Tells apart files of one thread.
+
+    static const PersistentQueueHeader& header(const TQueue* __queue) {
+      return *reinterpret_cast<const PersistentQueueHeader*>(reinterpret_cast<const char*>(__queue) -
+                                                             kPersistentQueueOffset);
+    }
+
+    static void* mapFile(const char* __path) {
+      int fd = open(__path, O_RDWR | O_CLOEXEC);
+      if (fd < 0) return nullptr;
+      struct stat status{};
+      if (fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) != kMappingSize) {
+        close(fd);
+        return nullptr;
+      }
+      void* mapping = mmap(nullptr, kMappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+      return mapping == MAP_FAILED ? nullptr : mapping;
+    }
+
+    template <class TRecord, class TCallback>
+    static std::size_t recoverFile(const std::string& __path, TCallback& __callback) {
+      void* mapping = mapFile(__path.c_str());
+      if (!mapping) return 0;
+
+      auto*       header   = static_cast<PersistentQueueHeader*>(mapping);
+      std::size_t replayed = 0;
+      bool        remove   = false;
+      if (isReplayable(*header)) {
+        auto*          queue = reinterpret_cast<TQueue*>(static_cast<char*>(mapping) + kPersistentQueueOffset);
+        std::ptrdiff_t delta = reinterpret_cast<std::intptr_t>(&PersistentQueueAnchor) -
+                               static_cast<std::intptr_t>(header->_mAnchor);
+        TRecord record;
+        while (queue->Dequeue(record)) {
+          __callback(record, delta);
+          ++replayed;
+        }
+        remove = true;
+      }
+      munmap(mapping, kMappingSize);
+      if (remove) {
+        unlink(__path.c_str());
+      }
+      return replayed;
+    }
+
+    static bool isReplayable(const PersistentQueueHeader& __header) {
+      if (memcmp(__header._mMagic, kPersistentQueueMagic, sizeof(__header._mMagic)) != 0 ||
+          __header._mQueueSize != sizeof(TQueue)) {
+        return false;
+      }
+      if (__header._mPid == getpid() || kill(__header._mPid, 0) == 0 || errno != ESRCH) {
+        return false;  // Owner still running (or this process), not ours to replay.
+      }
+      std::uint64_t exeSize;
+      std::int64_t  exeMtime;
+      executableIdentity(exeSize, exeMtime);
+      return exeSize == __header._mExeSize && exeMtime == __header._mExeMtime;
+    }
+
+    static void executableIdentity(std::uint64_t& __size, std::int64_t& __mtime) {
+      struct stat status{};
+      if (stat("/proc/self/exe", &status) != 0) {
+        __size  = 0;
+        __mtime = 0;
+        return;
+      }
+      __size  = static_cast<std::uint64_t>(status.st_size);
+      __mtime = static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1'000'000'000 + status.st_mtim.tv_nsec;
+    }
+  };
+}  // namespace SNJ
+
+#endif  // PERSISTENTQUEUE_HPP
@@ -0,0 +1,293 @@
+#ifndef ROTATINGLOGFILE_HPP
+#define ROTATINGLOGFILE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <unistd.h>
+
+#include "NonCopyMovable.hpp"
+
+namespace SNJ {
+
+  /**
+   * @brief When a RotatingLogFile switches to a new file.
+   *
+   * Both limits are optional; a zero value disables that trigger. With both disabled the
+   * file is never rotated and keeps the plain `<base>_<date>.log` name.
+   */
+  struct RotationPolicy {
+    std::size_t          _mMaxFileSize{0};  ///< Rotate once the live file reaches this many bytes.
+    std::chrono::seconds _mInterval{0};     ///< Rotate on local wall-clock boundaries of this length.
+
+    bool IsEnabled() const { return _mMaxFileSize != 0 || _mInterval.count() != 0; }
+  };
+
+  /**
+   * @class RotatingLogFile
+   * @brief Log file owned by the consumer thread that rotates by size and/or wall-clock interval.
+   *
+   * The next file is opened in the background under a hidden pending name while the current
+   * one is still being written. Rotation itself only renames the pending file and swaps the
+   * stream on the consumer thread; closing the old file and pre-opening the following one are
+   * handed back to the background. A `<base>_current.log` symlink always points at the live file.
+   * Producers never see any of this since they only touch their SPSC queues.
+   */
+  class RotatingLogFile {
+   public:
+    using FileStreamPtr   = std::unique_ptr<std::ofstream>;
+    using RotatedCallback = std::function<void(std::string)>;
+
+    /// Non-rotating file at a fixed path, appended to if it already exists.
+    RotatingLogFile(std::string_view __filePath)
+        : _mFilePath(__filePath), _mFileStream(std::make_unique<std::ofstream>(_mFilePath, std::ios::app)) {
+      publishSignalSafePath();
+    }
+
+    /**
+     * @brief File named after @p __baseFileName inside @p __logsDir, rotated according to @p __policy.
+     *        Without rotation the name only carries the date, so the file is appended to: a sink
+     *        re-created by a configuration reload, or sharing its name with a logger, keeps what
+     *        was written there today.
+     */
+    RotatingLogFile(std::string_view __logsDir, std::string_view __baseFileName, RotationPolicy __policy = {})
+        : _mLogsDir(__logsDir), _mBaseFileName(__baseFileName), _mPolicy(__policy) {
+      auto now   = std::chrono::system_clock::now();
+      _mFilePath = generateFileName(now);
+      _mFileStream = std::make_unique<std::ofstream>(_mFilePath, std::ios::app);
+      publishSignalSafePath();
+      if (_mPolicy.IsEnabled()) {
+        _mNextRotation = nextIntervalBoundary(now);
+        updateCurrentLink();
+        preOpenNext(nullptr);
+      }
+    }
+
+    MAKE_NON_COPYABLE(RotatingLogFile);
+    MAKE_NON_MOVABLE(RotatingLogFile);
+
+    ~RotatingLogFile() noexcept {
+      if (_mNextFileStream.valid()) {
+        _mNextFileStream.get().reset();
+        std::error_code ec;
+        std::filesystem::remove(pendingFileName(), ec);
+      }
+      _mFileStream->flush();
+      _mFileStream->close();
+    }
+
+    void Write(const char* __data, std::size_t __size) {
+      _mFileStream->write(__data, __size);
+      _mBytesWritten += __size;
+      if (_mPolicy._mMaxFileSize != 0 && _mBytesWritten >= _mPolicy._mMaxFileSize) {
+        Rotate();
+      }
+    }
+
+    void Flush() { _mFileStream->flush(); }
+
+    /**
+     * @brief Checks the wall-clock trigger. Called once per consumer pass rather than per record.
+     */
+    void RotateIfDue() {
+      if (_mPolicy._mInterval.count() != 0 && std::chrono::system_clock::now() >= _mNextRotation) {
+        Rotate();
+      }
+    }
+
+    /**
+     * @brief Switches to the pre-opened file if it is ready.
+     *
+     * If the background open has not finished yet the consumer keeps writing to the current
+     * file and the rotation is retried on the next trigger instead of blocking.
+     */
+    void Rotate() {
+      if (!_mNextFileStream.valid() ||
+          _mNextFileStream.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+      }
+
+      FileStreamPtr next = _mNextFileStream.get();
+      auto          now  = std::chrono::system_clock::now();
+      std::string   path = generateFileName(now);
+
+      std::error_code ec;
+      std::filesystem::rename(pendingFileName(), path, ec);
+      if (ec || !next || !next->is_open()) {
+        preOpenNext(nullptr);
+        return;
+      }
+
+      std::swap(_mFileStream, next);
+      std::swap(_mFilePath, path);
+      publishSignalSafePath();
+      _mBytesWritten = 0;
+      _mNextRotation = nextIntervalBoundary(now);
+      updateCurrentLink();
+      preOpenNext(std::move(next), std::move(path));
+    }
+
+    /**
+     * @brief Blocks until the background pre-open, if one is running, has finished.
+     */
+    void WaitForPendingOpen() {
+      if (_mNextFileStream.valid()) {
+        _mNextFileStream.wait();
+      }
+    }
+
+    /**
+     * @brief Changes the rotation triggers, starting with the next write. Consumer thread only.
+     *        Files opened at a fixed path never rotate.
+     */
+    void SetPolicy(RotationPolicy __policy) {
+      if (_mLogsDir.empty()) return;
+      _mPolicy       = __policy;
+      _mNextRotation = nextIntervalBoundary(std::chrono::system_clock::now());
+      if (_mPolicy.IsEnabled() && !_mNextFileStream.valid()) {
+        updateCurrentLink();
+        preOpenNext(nullptr);
+      }
+    }
+
+    const RotationPolicy& GetPolicy() const { return _mPolicy; }
+
+    const std::string& GetFilePath() const { return _mFilePath; }
+
+    /**
+     * @brief Path of the live file that can be read from a signal handler on any thread.
+     */
+    const char* GetSignalSafePath() const {
+      return _mSignalSafePath[_mSignalSafePathIndex.load(std::memory_order_acquire)];
+    }
+
+    /**
+     * @brief Invoked from the background thread with the path of each rotated file once it is closed.
+     *        Applies to rotations from the next one on; consumer thread, or before the file is
+     *        handed to it.
+     */
+    void SetRotatedCallback(RotatedCallback __callback) { _mRotatedCallback = std::move(__callback); }
+
+   private:
+    /**
+     * @brief Copies the live path into the spare buffer and flips the index, so a concurrent
+     *        reader never sees a partially written path.
+     */
+    void publishSignalSafePath() {
+      int next = 1 - _mSignalSafePathIndex.load(std::memory_order_relaxed);
+      std::strncpy(_mSignalSafePath[next], _mFilePath.c_str(), PATH_MAX - 1);
+      _mSignalSafePath[next][PATH_MAX - 1] = '\0';
+      _mSignalSafePathIndex.store(next, std::memory_order_release);
+    }
+
+    /**
+     * @brief Closes @p __previous and opens the following pending file on a background thread.
+     */
+    void preOpenNext(FileStreamPtr __previous, std::string __previousPath = {}) {
+      // The callback is copied here, so that the background thread never reads the member.
+      RotatedCallback callback = __previous ? _mRotatedCallback : RotatedCallback{};
+      _mNextFileStream         = std::async(std::launch::async,
+                                            [previous = std::move(__previous), previousPath = std::move(__previousPath),
+                                             callback = std::move(callback), pending = pendingFileName()]() mutable {
+        if (previous) {
+          previous->flush();
+          previous->close();
+          if (callback) {
+            callback(std::move(previousPath));
+          }
+        }
+        return std::make_unique<std::ofstream>(pending);
+      });
+    }
+
+    std::string generateFileName(std::chrono::system_clock::time_point __now) const {
+      std::time_t now_c = std::chrono::system_clock::to_time_t(__now);
+      std::tm     now_tm;
+      localtime_r(&now_c, &now_tm);
+
+      std::ostringstream oss;
+      oss << _mLogsDir << "/" << _mBaseFileName << "_" << std::put_time(&now_tm, "%Y-%m-%d");
+      if (!_mPolicy.IsEnabled()) {
+        oss << ".log";
+        return oss.str();
+      }
+
+      oss << "_" << std::put_time(&now_tm, "%H-%M-%S");
+      std::string stem = oss.str();
+      std::string name = stem + ".log";
+      for (unsigned sequence = 1; std::filesystem::exists(name); ++sequence) {
+        name = stem + "." + std::to_string(sequence) + ".log";
+      }
+      return name;
+    }
+
+    /**
+     * @brief Hidden name the next file is opened under. Tagged with the process and the
+     *        instance, since other files of the same base may rotate in the same directory.
+     */
+    std::string pendingFileName() const {
+      std::ostringstream oss;
+      oss << _mLogsDir << "/." << _mBaseFileName << "." << getpid() << "-" << std::hex
+          << reinterpret_cast<std::uintptr_t>(this) << ".pending.log";
+      return oss.str();
+    }
+
+    std::chrono::system_clock::time_point nextIntervalBoundary(std::chrono::system_clock::time_point __now) const {
+      if (_mPolicy._mInterval.count() == 0) {
+        return std::chrono::system_clock::time_point::max();
+      }
+      // Align boundaries to local time so that e.g. a 24h interval rotates at midnight.
+      std::time_t now_c = std::chrono::system_clock::to_time_t(__now);
+      std::tm     now_tm;
+      localtime_r(&now_c, &now_tm);
+      auto offset   = std::chrono::seconds(now_tm.tm_gmtoff);
+      auto local    = std::chrono::duration_cast<std::chrono::seconds>(__now.time_since_epoch()) + offset;
+      auto boundary = (local / _mPolicy._mInterval + 1) * _mPolicy._mInterval;
+      return std::chrono::system_clock::time_point(boundary - offset);
+    }
+
+    /**
+     * @brief Points `<base>_current.log` at the live file via symlink + rename so readers never
+     *        observe a missing link.
+     */
+    void updateCurrentLink() const {
+      std::error_code ec;
+      std::string     link    = _mLogsDir + "/" + _mBaseFileName + "_current.log";
+      std::string     tmpLink = _mLogsDir + "/." + _mBaseFileName + "_current.tmp";
+      std::filesystem::remove(tmpLink, ec);
+      std::filesystem::create_symlink(std::filesystem::path(_mFilePath).filename(), tmpLink, ec);
+      if (!ec) {
+        std::filesystem::rename(tmpLink, link, ec);
+      }
+    }
+
+    std::string                           _mLogsDir;
+    std::string                           _mBaseFileName;
+    RotationPolicy                        _mPolicy;
+    std::string                           _mFilePath;     ///< Path of the live file.
+    FileStreamPtr                         _mFileStream;   ///< Live file, only touched by the consumer.
+    std::future<FileStreamPtr>            _mNextFileStream;  ///< Pending file being opened in the background.
+    RotatedCallback                       _mRotatedCallback;
+    char                                  _mSignalSafePath[2][PATH_MAX] = {};
+    std::atomic<int>                      _mSignalSafePathIndex{0};
+    std::size_t                           _mBytesWritten{0};
+    std::chrono::system_clock::time_point _mNextRotation{std::chrono::system_clock::time_point::max()};
+  };
+}  // namespace SNJ
+
+#endif  // ROTATINGLOGFILE_HPP
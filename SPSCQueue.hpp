@@ -3,6 +3,7 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include "Macros.hpp"
 
@@ -14,7 +15,9 @@ namespace SNJ {
     FORCE_INLINE void Enqueue(Args&&... __args) {
       std::size_t writeIndex     = _mTail.load(std::memory_order_relaxed);
       std::size_t nextWriteIndex = getNextIndex(writeIndex);
-      while (nextWriteIndex == _mHead.load(std::memory_order_relaxed));
+      if (nextWriteIndex == _mHead.load(std::memory_order_relaxed)) [[unlikely]] {
+        waitForSpace(nextWriteIndex);
+      }
       new (&_mDataBuffer[writeIndex]) T(std::forward<Args>(__args)...);
       _mTail.store(nextWriteIndex, std::memory_order_release);
     }
@@ -22,14 +25,37 @@ namespace SNJ {
     FORCE_INLINE void Enqueue(T& __data) {
       std::size_t writeIndex     = _mTail.load(std::memory_order_relaxed);
       std::size_t nextWriteIndex = getNextIndex(writeIndex);
-      while (nextWriteIndex == _mHead.load(std::memory_order_relaxed));
+      if (nextWriteIndex == _mHead.load(std::memory_order_relaxed)) [[unlikely]] {
+        waitForSpace(nextWriteIndex);
+      }
       _mDataBuffer[writeIndex] = __data;
       _mTail.store(nextWriteIndex, std::memory_order_release);
     }
 
+    /**
+     * @brief Enqueues unless the queue is full, in which case the record is counted as dropped.
+     */
+    template <class... Args>
+    FORCE_INLINE bool TryEnqueue(Args&&... __args) {
+      std::size_t writeIndex     = _mTail.load(std::memory_order_relaxed);
+      std::size_t nextWriteIndex = getNextIndex(writeIndex);
+      if (nextWriteIndex == _mHead.load(std::memory_order_relaxed)) [[unlikely]] {
+        _mDrops.store(_mDrops.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return false;
+      }
+      new (&_mDataBuffer[writeIndex]) T(std::forward<Args>(__args)...);
+      _mTail.store(nextWriteIndex, std::memory_order_release);
+      return true;
+    }
+
     FORCE_INLINE bool Dequeue(T& __data) {
-      if (IsEmpty()) return false;
-      std::size_t readIndex = _mHead.load(std::memory_order_relaxed);
+      std::size_t readIndex  = _mHead.load(std::memory_order_relaxed);
+      std::size_t writeIndex = _mTail.load(std::memory_order_acquire);
+      if (readIndex == writeIndex) return false;
+      std::size_t depth = (writeIndex - readIndex) & kIndexMask;
+      if (depth > _mHighWaterMark.load(std::memory_order_relaxed)) {
+        _mHighWaterMark.store(depth, std::memory_order_relaxed);
+      }
       memcpy(&__data, &_mDataBuffer[readIndex], sizeof(T));
       _mHead.store(getNextIndex(readIndex), std::memory_order_relaxed);
       return true;
@@ -40,13 +66,36 @@ namespace SNJ {
       return false;
     }
 
+    /// Records currently queued; a snapshot when read from a third thread.
+    std::size_t GetSize() const {
+      return (_mTail.load(std::memory_order_acquire) - _mHead.load(std::memory_order_acquire)) & kIndexMask;
+    }
+
+    /// Deepest the queue has been when the consumer dequeued from it.
+    std::size_t GetHighWaterMark() const { return _mHighWaterMark.load(std::memory_order_relaxed); }
+
+    /// Enqueues that found the queue full and spun until the consumer made room.
+    std::uint64_t GetEnqueueSpins() const { return _mEnqueueSpins.load(std::memory_order_relaxed); }
+
+    /// Records TryEnqueue() discarded because the queue was full.
+    std::uint64_t GetDrops() const { return _mDrops.load(std::memory_order_relaxed); }
+
    private:
     std::size_t getNextIndex(std::size_t __index) { return (__index + 1) & kIndexMask; }
 
+    NO_INLINE void waitForSpace(std::size_t __nextWriteIndex) {
+      _mEnqueueSpins.store(_mEnqueueSpins.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      while (__nextWriteIndex == _mHead.load(std::memory_order_relaxed));
+    }
+
     inline static constexpr std::size_t kIndexMask = QueueSize - 1;
     T                                   _mDataBuffer[QueueSize];
     CACHE_ALIGN(std::atomic<std::size_t>) _mHead{0};
+    std::atomic<std::size_t> _mHighWaterMark{0};  ///< Consumer-written, shares the consumer's line.
     CACHE_ALIGN(std::atomic<std::size_t>) _mTail{0};
+    // Producer-written only, and only when the queue is full; kept off the lines the hot path shares.
+    CACHE_ALIGN(std::atomic<std::uint64_t>) _mEnqueueSpins{0};
+    std::atomic<std::uint64_t> _mDrops{0};
   };
 }  // namespace SNJ
 #endif
@@ -0,0 +1,110 @@
+#ifndef SHAREDQUEUEREGISTRY_HPP
+#define SHAREDQUEUEREGISTRY_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include <sys/mman.h>
+
+namespace SNJ {
+
+  /**
+   * @class SharedQueueRegistry
+   * @brief Control segment through which a logging daemon process discovers the shared-memory
+   *        queues of the application.
+   *
+   * Lives in an anonymous MAP_SHARED mapping created before the daemon is forked, so both
+   * processes see the same slots. A producer thread publishes its queue file once when it first
+   * logs and retires it when it exits; only the daemon frees slots again. Everything in here is
+   * a lock-free atomic, since a mutex shared between processes would not survive a crash of
+   * either side.
+   */
+  class SharedQueueRegistry {
+   public:
+    inline static constexpr std::size_t kMaxQueues = 1024;
+    inline static constexpr std::size_t kMaxPath   = 256;
+
+    enum class SlotState : std::uint32_t {
+      FREE,     ///< Unused.
+      CLAIMED,  ///< Being filled in by a producer.
+      ACTIVE,   ///< Queue in use by a live producer thread.
+      RETIRED,  ///< Producer thread exited; drain, remove the file and free the slot.
+    };
+
+    /**
+     * @brief Maps a new, empty registry. Must be called before forking the daemon.
+     * @return nullptr if the mapping failed.
+     */
+    static SharedQueueRegistry* Create() {
+      void* mapping = mmap(nullptr, sizeof(SharedQueueRegistry), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                           -1, 0);
+      return mapping == MAP_FAILED ? nullptr : new (mapping) SharedQueueRegistry();
+    }
+
+    static void Destroy(SharedQueueRegistry* __registry) {
+      __registry->~SharedQueueRegistry();
+      munmap(__registry, sizeof(SharedQueueRegistry));
+    }
+
+    /**
+     * @brief Announces the queue file at @p __path, consumed on behalf of logger @p __owner.
+     * @return slot to retire later, or -1 if the registry is full or the path too long.
+     */
+    int Publish(std::uintptr_t __owner, const char* __path) {
+      std::size_t length = strlen(__path);
+      if (length >= kMaxPath) return -1;
+      for (std::size_t i = 0; i < kMaxQueues; ++i) {
+        Slot&         slot     = _mSlots[i];
+        std::uint32_t expected = static_cast<std::uint32_t>(SlotState::FREE);
+        if (!slot._mState.compare_exchange_strong(expected, static_cast<std::uint32_t>(SlotState::CLAIMED),
+                                                  std::memory_order_acquire)) {
+          continue;
+        }
+        slot._mOwner = __owner;
+        memcpy(slot._mPath, __path, length + 1);
+        slot._mState.store(static_cast<std::uint32_t>(SlotState::ACTIVE), std::memory_order_release);
+        return static_cast<int>(i);
+      }
+      return -1;
+    }
+
+    void Retire(int __slot) {
+      _mSlots[__slot]._mState.store(static_cast<std::uint32_t>(SlotState::RETIRED), std::memory_order_release);
+    }
+
+    SlotState GetState(std::size_t __slot) const {
+      return static_cast<SlotState>(_mSlots[__slot]._mState.load(std::memory_order_acquire));
+    }
+
+    std::uintptr_t GetOwner(std::size_t __slot) const { return _mSlots[__slot]._mOwner; }
+
+    const char* GetPath(std::size_t __slot) const { return _mSlots[__slot]._mPath; }
+
+    /// Daemon side, once a retired queue has been drained.
+    void Free(std::size_t __slot) {
+      _mSlots[__slot]._mState.store(static_cast<std::uint32_t>(SlotState::FREE), std::memory_order_release);
+    }
+
+    void RequestStop() { _mStop.store(true, std::memory_order_release); }
+
+    bool IsStopRequested() const { return _mStop.load(std::memory_order_acquire); }
+
+   private:
+    struct Slot {
+      std::atomic<std::uint32_t> _mState{static_cast<std::uint32_t>(SlotState::FREE)};
+      std::uintptr_t             _mOwner{0};
+      char                       _mPath[kMaxPath]{};
+    };
+
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free && std::atomic<bool>::is_always_lock_free,
+                  "registry atomics must be address-free to be shared between processes");
+
+    std::atomic<bool> _mStop{false};
+    Slot              _mSlots[kMaxQueues];
+  };
+}  // namespace SNJ
+
+#endif  // SHAREDQUEUEREGISTRY_HPP
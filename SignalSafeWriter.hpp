@@ -0,0 +1,155 @@
+#ifndef SIGNALSAFEWRITER_HPP
+#define SIGNALSAFEWRITER_HPP
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string_view>
+
+#include <unistd.h>
+
+namespace SNJ {
+
+  /**
+   * @class SignalSafeWriter
+   * @brief Buffered writer to a file descriptor that only uses async-signal-safe operations.
+   *
+   * No allocation, no locale, no stdio: numbers are converted by hand and the buffer is
+   * drained with write(2). Used to render records from inside a crash signal handler.
+   */
+  class SignalSafeWriter {
+   public:
+    explicit SignalSafeWriter(int __fd) : _mFd(__fd) {}
+
+    ~SignalSafeWriter() { Flush(); }
+
+    void Append(const char* __data, std::size_t __size) {
+      while (__size > 0) {
+        if (_mSize == sizeof(_mBuffer)) Flush();
+        std::size_t chunk = sizeof(_mBuffer) - _mSize;
+        if (chunk > __size) chunk = __size;
+        memcpy(_mBuffer + _mSize, __data, chunk);
+        _mSize += chunk;
+        __data += chunk;
+        __size -= chunk;
+      }
+    }
+
+    void Append(std::string_view __text) { Append(__text.data(), __text.size()); }
+
+    void Append(char __c) { Append(&__c, 1); }
+
+    void AppendUnsigned(std::uint64_t __value) {
+      char  digits[20];
+      char* end = digits + sizeof(digits);
+      char* ptr = end;
+      do {
+        *--ptr = static_cast<char>('0' + __value % 10);
+        __value /= 10;
+      } while (__value != 0);
+      Append(ptr, static_cast<std::size_t>(end - ptr));
+    }
+
+    void AppendSigned(std::int64_t __value) {
+      if (__value < 0) {
+        Append('-');
+        AppendUnsigned(0 - static_cast<std::uint64_t>(__value));
+      } else {
+        AppendUnsigned(static_cast<std::uint64_t>(__value));
+      }
+    }
+
+    /**
+     * @brief Fixed notation with 6 decimals; magnitudes beyond 1e18 fall back to `d.dddddde+N`.
+     */
+    void AppendDouble(double __value) {
+      if (__value != __value) return Append("nan");
+      if (__value < 0) {
+        Append('-');
+        __value = -__value;
+      }
+      if (__value > 1.7976931348623157e308) return Append("inf");
+
+      int exponent = 0;
+      if (__value >= 1e18) {
+        while (__value >= 10.0) {
+          __value /= 10.0;
+          ++exponent;
+        }
+      }
+
+      auto integral = static_cast<std::uint64_t>(__value);
+      auto fraction = static_cast<std::uint64_t>((__value - static_cast<double>(integral)) * 1e6 + 0.5);
+      if (fraction >= 1000000) {
+        ++integral;
+        fraction -= 1000000;
+      }
+      AppendUnsigned(integral);
+      Append('.');
+      char digits[6];
+      for (int i = 5; i >= 0; --i) {
+        digits[i] = static_cast<char>('0' + fraction % 10);
+        fraction /= 10;
+      }
+      Append(digits, sizeof(digits));
+      if (exponent != 0) {
+        Append("e+");
+        AppendUnsigned(static_cast<std::uint64_t>(exponent));
+      }
+    }
+
+    /**
+     * @brief `YYYY-MM-DD HH:MM:SS` in UTC, computed without localtime/gmtime.
+     */
+    void AppendUtcTime(std::time_t __time) {
+      std::int64_t days    = __time / 86400;
+      std::int64_t seconds = __time % 86400;
+      if (seconds < 0) {
+        seconds += 86400;
+        --days;
+      }
+      // Civil date from days since 1970-01-01 (H. Hinnant's algorithm).
+      days += 719468;
+      std::int64_t era   = (days >= 0 ? days : days - 146096) / 146097;
+      std::int64_t doe   = days - era * 146097;
+      std::int64_t yoe   = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+      std::int64_t doy   = doe - (365 * yoe + yoe / 4 - yoe / 100);
+      std::int64_t mp    = (5 * doy + 2) / 153;
+      std::int64_t day   = doy - (153 * mp + 2) / 5 + 1;
+      std::int64_t month = mp < 10 ? mp + 3 : mp - 9;
+      std::int64_t year  = yoe + era * 400 + (month <= 2);
+
+      AppendSigned(year);
+      appendTwoDigits('-', month);
+      appendTwoDigits('-', day);
+      appendTwoDigits(' ', seconds / 3600);
+      appendTwoDigits(':', seconds / 60 % 60);
+      appendTwoDigits(':', seconds % 60);
+    }
+
+    void Flush() {
+      std::size_t written = 0;
+      while (written < _mSize) {
+        ssize_t result = write(_mFd, _mBuffer + written, _mSize - written);
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) break;
+        written += static_cast<std::size_t>(result);
+      }
+      _mSize = 0;
+    }
+
+   private:
+    void appendTwoDigits(char __separator, std::int64_t __value) {
+      char text[3] = {__separator, static_cast<char>('0' + __value / 10), static_cast<char>('0' + __value % 10)};
+      Append(text, sizeof(text));
+    }
+
+    int         _mFd;
+    std::size_t _mSize{0};
+    char        _mBuffer[4096];
+  };
+}  // namespace SNJ
+
+#endif  // SIGNALSAFEWRITER_HPP
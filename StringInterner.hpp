@@ -0,0 +1,244 @@
+#ifndef STRINGINTERNER_HPP
+#define STRINGINTERNER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "FastLogCodec.hpp"
+#include "NonCopyMovable.hpp"
+
+namespace SNJ {
+
+  /**
+   * @class Interned
+   * @brief Opt-in argument type for strings that recur in many records, such as instrument
+   *        symbols or account IDs: records carry a 4-byte ID instead of the characters.
+   *
+   * The first time a thread logs a string through a logger, a dictionary record mapping its ID
+   * to the characters goes into that queue ahead of the record using it, and the consumer adds
+   * it to the InternDictionary. If that record cannot be queued, the record using the string
+   * carries the characters instead. IDs are never released, so intern a bounded set of strings;
+   * longer ones are truncated to kMaxLength.
+   */
+  class Interned {
+   public:
+    inline static constexpr std::size_t kMaxLength = 256;
+
+    explicit Interned(std::string_view __value) : _mValue(__value.substr(0, kMaxLength)) {}
+
+    std::string_view View() const { return _mValue; }
+
+    std::uint32_t GetId() const { return _mId; }
+
+    /// Called by FastLogger::Log before the record is encoded.
+    void SetId(std::uint32_t __id) const { _mId = __id; }
+
+   private:
+    std::string_view      _mValue;
+    mutable std::uint32_t _mId{0};
+  };
+
+  /**
+   * @brief Hash of strings that can be looked up by std::string_view without a copy.
+   */
+  struct StringViewHash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view __value) const { return std::hash<std::string_view>{}(__value); }
+  };
+
+  using InternIdMap = std::unordered_map<std::string, std::uint32_t, StringViewHash, std::equal_to<>>;
+
+  /**
+   * @class InternDictionary
+   * @brief Consumer side reverse mapping of interned IDs to their strings, filled from
+   *        dictionary records. Lookups are lock-free, and async-signal-safe once defined.
+   */
+  class InternDictionary {
+   public:
+    inline static constexpr std::size_t kChunkSize = 4096;
+    inline static constexpr std::size_t kChunks    = 1024;
+    inline static constexpr std::size_t kCapacity  = kChunkSize * kChunks;  ///< IDs, 0 excluded.
+
+    InternDictionary() = default;
+
+    ~InternDictionary() {
+      for (auto& entry : _mChunks) {
+        if (Chunk* chunk = entry.load(std::memory_order_relaxed)) {
+          for (auto& slot : *chunk) {
+            delete slot.load(std::memory_order_relaxed);
+          }
+          delete chunk;
+        }
+      }
+    }
+
+    MAKE_NON_COPYABLE(InternDictionary);
+    MAKE_NON_MOVABLE(InternDictionary);
+
+    /**
+     * @brief Maps @p __id to @p __value. Every queue that uses an ID defines it, so the first
+     *        definition is kept and the others are ignored.
+     */
+    void Define(std::uint32_t __id, std::string_view __value) {
+      if (__id == 0 || __id >= kCapacity) return;
+      std::atomic<const std::string*>& slot = slotOf(__id);
+      if (slot.load(std::memory_order_acquire)) return;
+      const std::string* expected = nullptr;
+      const std::string* text     = new std::string(__value);
+      if (!slot.compare_exchange_strong(expected, text, std::memory_order_release, std::memory_order_relaxed)) {
+        delete text;
+      }
+    }
+
+    /// String of @p __id, or nullptr if no dictionary record has defined it.
+    const std::string* Find(std::uint32_t __id) const {
+      if (__id == 0 || __id >= kCapacity) return nullptr;
+      Chunk* chunk = _mChunks[__id / kChunkSize].load(std::memory_order_acquire);
+      return chunk ? (*chunk)[__id % kChunkSize].load(std::memory_order_acquire) : nullptr;
+    }
+
+    /**
+     * @brief Dictionary records are added to and interned arguments rendered from: the
+     *        process-wide one, unless a ScopedOverride is active on the calling thread.
+     */
+    static InternDictionary& Current() { return sOverride ? *sOverride : process(); }
+
+    /**
+     * @brief Makes another dictionary current on this thread, e.g. while rendering records of
+     *        another process, whose IDs mean something else.
+     */
+    class ScopedOverride {
+     public:
+      explicit ScopedOverride(InternDictionary& __dictionary) : _mPrevious(sOverride) { sOverride = &__dictionary; }
+
+      ~ScopedOverride() { sOverride = _mPrevious; }
+
+      MAKE_NON_COPYABLE(ScopedOverride);
+      MAKE_NON_MOVABLE(ScopedOverride);
+
+     private:
+      InternDictionary* _mPrevious;
+    };
+
+   private:
+    using Chunk = std::array<std::atomic<const std::string*>, kChunkSize>;
+
+    std::atomic<const std::string*>& slotOf(std::uint32_t __id) {
+      std::atomic<Chunk*>& entry = _mChunks[__id / kChunkSize];
+      Chunk*               chunk = entry.load(std::memory_order_acquire);
+      if (!chunk) {
+        Chunk* fresh = new Chunk{};
+        if (entry.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel)) {
+          chunk = fresh;
+        } else {
+          delete fresh;
+        }
+      }
+      return (*chunk)[__id % kChunkSize];
+    }
+
+    // Intentionally leaked: consumers of static loggers may still render during exit.
+    static InternDictionary& process() {
+      static InternDictionary* sDictionary = new InternDictionary();
+      return *sDictionary;
+    }
+
+    std::atomic<Chunk*> _mChunks[kChunks] = {};
+
+    inline static thread_local constinit InternDictionary* sOverride = nullptr;
+  };
+
+  /**
+   * @class StringInterner
+   * @brief Producer side of interning for one queue: the strings whose dictionary record this
+   *        queue has carried, in front of the process-wide assignment of IDs, so that a string
+   *        keeps its ID across threads and loggers. Not thread-safe; owned by the queue.
+   */
+  class StringInterner {
+   public:
+    inline static constexpr std::uint32_t kNoId = 0;
+
+    /// ID of @p __value if its dictionary record went through this queue, else kNoId.
+    std::uint32_t Find(std::string_view __value) const {
+      auto entry = _mSent.find(__value);
+      return entry == _mSent.end() ? kNoId : entry->second;
+    }
+
+    /// Remembers that the dictionary record of @p __id went through this queue.
+    void MarkSent(std::string_view __value, std::uint32_t __id) { _mSent.emplace(__value, __id); }
+
+    /**
+     * @brief ID of @p __value in this process, assigned on first use; kNoId once
+     *        InternDictionary::kCapacity strings have been interned.
+     */
+    static std::uint32_t Assign(std::string_view __value) {
+      std::lock_guard<std::mutex> lock(mutex());
+      InternIdMap&                ids   = assigned();
+      auto                        entry = ids.find(__value);
+      if (entry != ids.end()) return entry->second;
+      if (ids.size() + 1 >= InternDictionary::kCapacity) return kNoId;
+      auto id = static_cast<std::uint32_t>(ids.size() + 1);
+      ids.emplace(__value, id);
+      return id;
+    }
+
+   private:
+    static std::mutex& mutex() {
+      static std::mutex sMutex;
+      return sMutex;
+    }
+
+    static InternIdMap& assigned() {
+      static InternIdMap* sAssigned = new InternIdMap();
+      return *sAssigned;
+    }
+
+    InternIdMap _mSent;
+  };
+
+  /**
+   * @brief Stores the ID of an Interned string; the consumer looks the characters up in the
+   *        current InternDictionary. An argument left without an ID, because its dictionary
+   *        record was dropped or the dictionary is full, carries its characters after kNoId.
+   */
+  template <>
+  struct FastLogCodec<Interned> {
+    using Id = MemcpyCodec<std::uint32_t>;
+
+    static std::size_t EncodedSize(const Interned& __value) {
+      return sizeof(std::uint32_t) +
+             (__value.GetId() == StringInterner::kNoId ? StringCodec::EncodedSize(__value.View()) : 0);
+    }
+
+    static char* Encode(char* __buffer, const Interned& __value) {
+      __buffer = Id::Encode(__buffer, __value.GetId());
+      return __value.GetId() == StringInterner::kNoId ? StringCodec::Encode(__buffer, __value.View()) : __buffer;
+    }
+
+    /// The interned characters; @p __data is moved past the ID, and the characters if inline.
+    static std::string_view View(const char*& __data) {
+      std::uint32_t id = Id::Decode(__data);
+      __data += sizeof(std::uint32_t);
+      if (id == StringInterner::kNoId) return StringCodec::View(__data);
+      const std::string* text = InternDictionary::Current().Find(id);
+      return text ? std::string_view(*text) : std::string_view("<unknown interned string>");
+    }
+
+    static const char* Render(const char* __data, std::ostream& __stream) {
+      std::string_view text = View(__data);
+      __stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+      return __data;
+    }
+  };
+}  // namespace SNJ
+
+#endif  // STRINGINTERNER_HPP
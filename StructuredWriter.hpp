@@ -0,0 +1,163 @@
+#ifndef STRUCTUREDWRITER_HPP
+#define STRUCTUREDWRITER_HPP
+
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "LogSink.hpp"
+
+namespace SNJ {
+
+  /**
+   * @brief Index of the first byte at or after @p __index that cannot be copied verbatim into a
+   *        JSON string: `"`, `\` or a control character. With @p TLogfmt space and `=` also
+   *        count, since they force a logfmt value to be quoted. Scans 16 bytes at a time with SSE2.
+   */
+  template <bool TLogfmt>
+  inline std::size_t FindSpecialChar(const char* __data, std::size_t __size, std::size_t __index = 0) {
+#if defined(__SSE2__)
+    const __m128i quote     = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i controlHi = _mm_set1_epi8(0x1F);
+    [[maybe_unused]] const __m128i space  = _mm_set1_epi8(' ');
+    [[maybe_unused]] const __m128i equals = _mm_set1_epi8('=');
+    for (; __index + 16 <= __size; __index += 16) {
+      __m128i chunk   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(__data + __index));
+      __m128i special = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+      // Unsigned chunk <= 0x1F  <=>  max(chunk, 0x1F) == 0x1F
+      special = _mm_or_si128(special, _mm_cmpeq_epi8(_mm_max_epu8(chunk, controlHi), controlHi));
+      if constexpr (TLogfmt) {
+        special = _mm_or_si128(special, _mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, equals)));
+      }
+      int mask = _mm_movemask_epi8(special);
+      if (mask != 0) {
+        return __index + static_cast<std::size_t>(__builtin_ctz(mask));
+      }
+    }
+#endif
+    for (; __index < __size; ++__index) {
+      auto c = static_cast<unsigned char>(__data[__index]);
+      if (c == '"' || c == '\\' || c <= 0x1F || (TLogfmt && (c == ' ' || c == '='))) {
+        return __index;
+      }
+    }
+    return __size;
+  }
+
+  /**
+   * @brief Appends @p __value with JSON string escaping, without the surrounding quotes.
+   */
+  inline void AppendJsonEscaped(std::string& __output, std::string_view __value) {
+    std::size_t start = 0;
+    while (true) {
+      std::size_t special = FindSpecialChar<false>(__value.data(), __value.size(), start);
+      __output.append(__value.data() + start, special - start);
+      if (special == __value.size()) return;
+
+      auto c = static_cast<unsigned char>(__value[special]);
+      switch (c) {
+        case '"': __output += "\\\""; break;
+        case '\\': __output += "\\\\"; break;
+        case '\n': __output += "\\n"; break;
+        case '\r': __output += "\\r"; break;
+        case '\t': __output += "\\t"; break;
+        default: {
+          constexpr char kHex[] = "0123456789abcdef";
+          char           escaped[] = {'\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF]};
+          __output.append(escaped, sizeof(escaped));
+        }
+      }
+      start = special + 1;
+    }
+  }
+
+  /**
+   * @class StructuredWriter
+   * @brief Appends `key: value` fields to a JSON object or a logfmt line.
+   *
+   * The caller writes the enclosing `{`/`}` for JSON; the writer only takes care of separators,
+   * quoting and escaping. Numbers are rendered with std::to_chars.
+   */
+  class StructuredWriter {
+   public:
+    StructuredWriter(RenderFormat __format, std::string& __output) : _mFormat(__format), _mOutput(__output) {}
+
+    void Key(std::string_view __key) {
+      if (!_mFirst) {
+        _mOutput += _mFormat == RenderFormat::JSON ? ',' : ' ';
+      }
+      _mFirst = false;
+      if (_mFormat == RenderFormat::JSON) {
+        _mOutput += '"';
+        AppendJsonEscaped(_mOutput, __key);
+        _mOutput += "\":";
+      } else {
+        _mOutput += __key;
+        _mOutput += '=';
+      }
+    }
+
+    void String(std::string_view __value) {
+      if (_mFormat == RenderFormat::LOGFMT && !__value.empty() &&
+          FindSpecialChar<true>(__value.data(), __value.size()) == __value.size()) {
+        _mOutput += __value;
+        return;
+      }
+      _mOutput += '"';
+      AppendJsonEscaped(_mOutput, __value);
+      _mOutput += '"';
+    }
+
+    template <class T>
+    void Number(T __value) {
+      if constexpr (std::is_same_v<T, bool>) {
+        _mOutput += __value ? "true" : "false";
+      } else if constexpr (std::is_floating_point_v<T>) {
+        if (!std::isfinite(__value)) {
+          // Not valid JSON numbers, emitted as strings instead.
+          String(std::isnan(__value) ? "NaN" : (__value > 0 ? "Infinity" : "-Infinity"));
+          return;
+        }
+        appendChars(__value);
+      } else if constexpr (std::is_same_v<T, char> || std::is_same_v<T, signed char> ||
+                           std::is_same_v<T, unsigned char>) {
+        String(std::string_view(reinterpret_cast<const char*>(&__value), 1));
+      } else {
+        appendChars(__value);
+      }
+    }
+
+    template <class T>
+    void Field(std::string_view __key, const T& __value) {
+      Key(__key);
+      if constexpr (std::is_arithmetic_v<T>) {
+        Number(__value);
+      } else {
+        String(__value);
+      }
+    }
+
+   private:
+    template <class T>
+    void appendChars(T __value) {
+      char buffer[64];
+      auto result = std::to_chars(buffer, buffer + sizeof(buffer), __value);
+      _mOutput.append(buffer, result.ptr);
+    }
+
+    RenderFormat _mFormat;
+    std::string& _mOutput;
+    bool         _mFirst{true};
+  };
+}  // namespace SNJ
+
+#endif  // STRUCTUREDWRITER_HPP
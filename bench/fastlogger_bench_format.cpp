@@ -0,0 +1,200 @@
+/**
+ * @file fastlogger_bench_format.cpp
+ * @brief Consumer-side rendering cost, independent of queues and disk.
+ *
+ * Records of a few corpora of realistic call sites are captured once from a logger without
+ * sinks, then every stage of FastLogger's rendering runs over them in a loop:
+ *  - evaluate     LogFormatter::Evaluate into the reused stream
+ *  - timestamp    the `[%Y-%m-%d %H:%M:%S] ` prefix of text lines, clock read included
+ *  - level        LogLevelToString
+ *  - text line    the three above, composed as FastLogger renders a text line
+ *  - logfmt/json  a structured line through StructuredWriter and EvaluateFields
+ *
+ * The composed stages mirror FastLogger::render(); keep them in step when it changes.
+ * Reported as ns/record and rendered MB/s.
+ *
+ * Build and run (from the repository root):
+ * @code
+ *   g++ -std=c++20 -O2 -march=native -I. bench/fastlogger_bench_format.cpp -o fastlogger_bench_format -pthread
+ *   ./fastlogger_bench_format [records per corpus]
+ * @endcode
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "FastLogger.hpp"
+
+namespace {
+  using namespace SNJ;
+  using Clock = std::chrono::steady_clock;
+
+  /// Minimum measured time per row; passes over the corpus repeat until it is reached.
+  constexpr auto kMinDuration = std::chrono::milliseconds(300);
+
+  /**
+   * @brief Records logged by @p __produce, taken out of the logger's queue before any consumer
+   *        sees them. The queue holds fewer records than a corpus, so it is emptied in rounds.
+   */
+  template <class TProduce>
+  std::vector<LogMessage> captureCorpus(const std::shared_ptr<FastLogger>& __logger, std::size_t __records,
+                                        TProduce __produce) {
+    std::vector<LogMessage> corpus;
+    corpus.reserve(__records);
+    for (std::size_t i = 0; i < __records;) {
+      for (std::size_t batch = 0; batch < 512 && i < __records; ++batch, ++i) {
+        __produce(__logger, i);
+      }
+      __logger->_mThreadScopedQueueManager->ForEachQueue([&corpus](MessageQueue& __queue) {
+        LogMessage message;
+        while (__queue.Dequeue(message)) {
+          corpus.push_back(message);
+        }
+      });
+    }
+    return corpus;
+  }
+
+  LogLevel levelOf(const LogMessage& __message) { return *reinterpret_cast<const LogLevel*>(__message._mDataBuffer); }
+
+  const char* argumentsOf(const LogMessage& __message) { return __message._mDataBuffer + sizeof(LogLevel); }
+
+  /**
+   * @brief Runs @p __stage over the corpus until kMinDuration has passed and prints the rate.
+   *        @p __stage returns the bytes it rendered for one record.
+   */
+  template <class TStage>
+  void measure(const char* __corpus, const char* __name, const std::vector<LogMessage>& __messages,
+               TStage __stage) {
+    std::size_t records = 0;
+    std::size_t bytes   = 0;
+    auto        start   = Clock::now();
+    auto        elapsed = Clock::duration{};
+    do {
+      for (const LogMessage& message : __messages) {
+        bytes += __stage(message);
+      }
+      records += __messages.size();
+      elapsed = Clock::now() - start;
+    } while (elapsed < kMinDuration);
+
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    std::printf("%-10s %-12s %10.1f %10.1f %10.1f\n", __corpus, __name, seconds * 1e9 / static_cast<double>(records),
+                static_cast<double>(bytes) / static_cast<double>(records),
+                static_cast<double>(bytes) / seconds / 1e6);
+  }
+
+  void runStages(const char* __corpus, const std::vector<LogMessage>& __messages) {
+    std::ostringstream stream;
+    std::string        output;
+
+    measure(__corpus, "evaluate", __messages, [&stream](const LogMessage& __message) {
+      stream.str({});
+      __message._mFormatter->Evaluate(argumentsOf(__message), stream);
+      return static_cast<std::size_t>(stream.tellp());
+    });
+
+    measure(__corpus, "timestamp", __messages, [&stream](const LogMessage&) {
+      std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+      std::tm     tm_buf;
+      localtime_r(&now, &tm_buf);
+      stream.str({});
+      stream << "[" << std::put_time(&tm_buf, "%Y-%m-%d %H:%M:%S") << "] ";
+      return static_cast<std::size_t>(stream.tellp());
+    });
+
+    measure(__corpus, "level", __messages,
+            [](const LogMessage& __message) { return LogLevelToString(levelOf(__message)).size(); });
+
+    measure(__corpus, "text line", __messages, [&stream, &output](const LogMessage& __message) {
+      std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+      std::tm     tm_buf;
+      localtime_r(&now, &tm_buf);
+      stream.str({});
+      stream << "[" << std::put_time(&tm_buf, "%Y-%m-%d %H:%M:%S") << "] ";
+      stream << "[" << LogLevelToString(levelOf(__message)) << "] ";
+      __message._mFormatter->Evaluate(argumentsOf(__message), stream);
+      stream << "\n";
+      output = stream.str();
+      return output.size();
+    });
+
+    for (RenderFormat format : {RenderFormat::LOGFMT, RenderFormat::JSON}) {
+      measure(__corpus, format == RenderFormat::JSON ? "json line" : "logfmt line", __messages,
+              [format, &stream, &output](const LogMessage& __message) {
+                std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+                std::tm     tm_buf;
+                localtime_r(&now, &tm_buf);
+                char timestamp[32];
+                std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &tm_buf);
+
+                output.clear();
+                if (format == RenderFormat::JSON) output += '{';
+                StructuredWriter writer(format, output);
+                writer.Field("ts", std::string_view(timestamp));
+                writer.Field("level", LogLevelToString(levelOf(__message)));
+                writer.Field("site", __message._mFormatter->GetSite());
+                __message._mFormatter->EvaluateFields(argumentsOf(__message), writer, stream);
+                if (format == RenderFormat::JSON) output += '}';
+                output += '\n';
+                return output.size();
+              });
+    }
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t records = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4096;
+
+  const std::string symbols[] = {"AAPL", "MSFT", "BRK.B", "GOOGL", "TSLA"};
+  const std::string longText(180, 'p');
+
+  auto logger = std::make_shared<FastLogger>();
+  logger->SetLogLevel(LogLevel::DEBUG);
+
+  auto numeric = captureCorpus(logger, records, [](auto& __logger, std::size_t __i) {
+    switch (__i % 4) {
+      case 0: LOG_INFO(__logger, "seq {} ack", __i); break;
+      case 1: LOG_INFO(__logger, "latency {} us p99 {} us", 12.5 + __i % 100, 250.75); break;
+      case 2: LOG_DEBUG(__logger, "{} {} {} {}", __i, __i * 3, -static_cast<long>(__i), __i % 7); break;
+      default: LOG_INFO(__logger, "queue depth {} of {}", static_cast<int>(__i % 1024), 1024); break;
+    }
+  });
+
+  auto text = captureCorpus(logger, records, [&symbols, &longText](auto& __logger, std::size_t __i) {
+    switch (__i % 3) {
+      case 0: LOG_INFO(__logger, "session {} connected from {}", symbols[__i % 5], "10.1.2.3:51234"); break;
+      case 1: LOG_ERROR(__logger, "rejected: {}", longText); break;
+      default: LOG_INFO(__logger, "heartbeat"); break;
+    }
+  });
+
+  auto mixed = captureCorpus(logger, records, [&symbols](auto& __logger, std::size_t __i) {
+    switch (__i % 4) {
+      case 0: LOG_INFO(__logger, "fill {} {} @ {} id {}", symbols[__i % 5], 100 * (__i % 9 + 1), 101.25, __i); break;
+      case 1: LOG_DEBUG(__logger, "book {} bid {} ask {}", symbols[__i % 5], 101.24, 101.26); break;
+      case 2: LOG_INFO_CAT(__logger, "net", "sent {} bytes to {}", 1400 + __i % 100, "gw-2"); break;
+      default: LOG_ERROR(__logger, "order {} rejected: {}", __i, "insufficient margin"); break;
+    }
+  });
+
+  auto kv = captureCorpus(logger, records, [&symbols](auto& __logger, std::size_t __i) {
+    LOG_INFO_KV(__logger, "fill", "symbol", symbols[__i % 5], "qty", 100 * (__i % 9 + 1), "px", 101.25, "id", __i);
+  });
+
+  std::printf("%zu records per corpus\n\n", records);
+  std::printf("%-10s %-12s %10s %10s %10s\n", "corpus", "stage", "ns/record", "bytes/rec", "MB/s");
+  runStages("numeric", numeric);
+  runStages("text", text);
+  runStages("mixed", mixed);
+  runStages("kv", kv);
+  return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file fastlogger_bench_latency.cpp
+ * @brief Producer hot-path cost of one LOG_INFO call, in TSC cycles.
+ *
+ * Every call is timed on its own and the distribution is reported per scenario:
+ * argument mix x queue fill state x enabled/filtered level. No consumer thread runs; the
+ * queue is pre-filled to the wanted state, a short batch is timed, and the queue is drained
+ * between batches on the producer thread itself, so the numbers are the cost of
+ * FastLogger::Log and SPSCQueue::Enqueue alone.
+ *
+ * Build and run (from the repository root):
+ * @code
+ *   g++ -std=c++20 -O2 -march=native -I. bench/fastlogger_bench_latency.cpp -o fastlogger_bench_latency -pthread
+ *   taskset -c 2 ./fastlogger_bench_latency [rounds]
+ * @endcode
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "FastLogger.hpp"
+
+namespace {
+  using namespace SNJ;
+
+  /// Cycle counter, or nanoseconds where no TSC is available.
+  inline std::uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_lfence();
+    std::uint64_t cycles = __rdtsc();
+    _mm_lfence();
+    return cycles;
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+  }
+
+  double cyclesPerNs() {
+    auto          start       = std::chrono::steady_clock::now();
+    std::uint64_t startCycles = readCycles();
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(200));
+    std::uint64_t cycles = readCycles() - startCycles;
+    auto          ns     = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(cycles) / static_cast<double>(ns.count());
+  }
+
+  struct FillState {
+    const char* _mName;
+    std::size_t _mPrefill;  ///< Records queued before the timed batch.
+  };
+
+  /// Timed calls per batch; the near-full state leaves just enough room for them.
+  constexpr std::size_t kBatch = 16;
+
+  constexpr FillState kFillStates[] = {{"empty", 0}, {"half", 512}, {"near-full", 1000}};
+
+  class LatencyBench {
+   public:
+    explicit LatencyBench(std::size_t __rounds) : _mRounds(__rounds), _mLogger(std::make_shared<FastLogger>()) {
+      _mLogger->AddSink(std::make_shared<NullSink>());
+      _mOverhead = measureOverhead();
+      _mCyclesPerNs = cyclesPerNs();
+      std::printf("timer overhead %llu cycles subtracted, %.2f cycles/ns, %zu samples per row\n\n",
+                  static_cast<unsigned long long>(_mOverhead), _mCyclesPerNs, _mRounds * kBatch);
+      std::printf("%-22s %-10s %-9s %8s %8s %8s %8s %10s\n", "arguments", "queue", "level", "p50", "p99", "p99.9",
+                  "max", "p50 ns");
+    }
+
+    /**
+     * @brief Times @p __call in every fill state with the level enabled and filtered.
+     */
+    template <class TCall>
+    void Run(const char* __name, TCall __call) {
+      for (bool filtered : {false, true}) {
+        _mLogger->SetLogLevel(filtered ? LogLevel::ERROR : LogLevel::DEBUG);
+        for (const FillState& fill : kFillStates) {
+          if (filtered && fill._mPrefill != 0) continue;  // Nothing is enqueued; the fill state is irrelevant.
+          report(__name, fill._mName, filtered ? "filtered" : "enabled", measure(fill, __call));
+        }
+      }
+    }
+
+    const std::shared_ptr<FastLogger>& GetLogger() const { return _mLogger; }
+
+   private:
+    template <class TCall>
+    std::vector<std::uint64_t> measure(const FillState& __fill, TCall& __call) {
+      std::vector<std::uint64_t> samples;
+      samples.reserve(_mRounds * kBatch);
+      for (std::size_t round = 0; round <= _mRounds; ++round) {
+        prefill(__fill._mPrefill);
+        for (std::size_t i = 0; i < kBatch; ++i) {
+          std::uint64_t start = readCycles();
+          __call(_mLogger);
+          std::uint64_t cycles = readCycles() - start;
+          if (round != 0) {  // First round warms caches and creates the thread's queue.
+            samples.push_back(cycles > _mOverhead ? cycles - _mOverhead : 0);
+          }
+        }
+        _mLogger->ConsumeAndWriteLogs();
+      }
+      return samples;
+    }
+
+    void prefill(std::size_t __count) {
+      // Enabled regardless of the level under test, so that the queue really fills up.
+      LogLevel logLevel = _mLogger->GetLogLevel();
+      _mLogger->SetLogLevel(LogLevel::DEBUG);
+      for (std::size_t i = 0; i < __count; ++i) {
+        LOG_INFO(_mLogger, "prefill {}", i);
+      }
+      _mLogger->SetLogLevel(logLevel);
+    }
+
+    std::uint64_t measureOverhead() {
+      std::uint64_t best = ~0ull;
+      for (int i = 0; i < 100000; ++i) {
+        std::uint64_t start = readCycles();
+        best                = std::min(best, readCycles() - start);
+      }
+      return best;
+    }
+
+    void report(const char* __name, const char* __fill, const char* __level, std::vector<std::uint64_t> __samples) {
+      std::sort(__samples.begin(), __samples.end());
+      auto percentile = [&__samples](double __p) {
+        std::size_t index = static_cast<std::size_t>(__p * static_cast<double>(__samples.size() - 1));
+        return static_cast<unsigned long long>(__samples[index]);
+      };
+      std::printf("%-22s %-10s %-9s %8llu %8llu %8llu %8llu %10.1f\n", __name, __fill, __level, percentile(0.5),
+                  percentile(0.99), percentile(0.999), static_cast<unsigned long long>(__samples.back()),
+                  static_cast<double>(percentile(0.5)) / _mCyclesPerNs);
+    }
+
+    std::size_t                 _mRounds;
+    std::shared_ptr<FastLogger> _mLogger;
+    std::uint64_t               _mOverhead{0};
+    double                      _mCyclesPerNs{1.0};
+  };
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t  rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  LatencyBench bench(rounds);
+
+  const std::string shortString = "order-42";
+  const std::string longString(200, 'x');
+
+  bench.Run("none", [](auto& __logger) { LOG_INFO(__logger, "heartbeat"); });
+  bench.Run("int", [](auto& __logger) { LOG_INFO(__logger, "seq {}", 42); });
+  bench.Run("4 x int64", [](auto& __logger) {
+    LOG_INFO(__logger, "{} {} {} {}", std::int64_t{1}, std::int64_t{2}, std::int64_t{3}, std::int64_t{4});
+  });
+  bench.Run("double", [](auto& __logger) { LOG_INFO(__logger, "price {}", 101.25); });
+  bench.Run("const char*", [](auto& __logger) { LOG_INFO(__logger, "side {}", "BUY"); });
+  bench.Run("string 8B", [&shortString](auto& __logger) { LOG_INFO(__logger, "id {}", shortString); });
+  bench.Run("interned 8B", [&shortString](auto& __logger) { LOG_INFO(__logger, "id {}", Interned(shortString)); });
+  bench.Run("string 200B", [&longString](auto& __logger) { LOG_INFO(__logger, "payload {}", longString); });
+  bench.Run("int+double+string", [&shortString](auto& __logger) {
+    LOG_INFO(__logger, "fill {} qty {} px {}", shortString, 100, 101.25);
+  });
+  return 0;
+}
@@ -0,0 +1,206 @@
+/**
+ * @file fastlogger_bench_throughput.cpp
+ * @brief End-to-end throughput of 1..N producer threads through LogManager's consumer.
+ *
+ * For every sink (the logger's own file in the logs directory, a file on tmpfs, a null sink),
+ * flush policy and producer count, each producer logs a fixed number of records as fast as it
+ * can and the run ends once the consumer has written the last one. Reported per run:
+ *  - msgs/s     records written per second of wall time, first enqueue to last write
+ *  - max lag    most records queued but not yet written, sampled every millisecond
+ *  - drain ms   time the consumer needed after the last producer finished
+ *  - lost       records enqueued but never written (queues block when full, so expected 0)
+ *  - cons cpu   CPU time of the consumer thread, as process time minus the threads of the
+ *               benchmark itself, and its share of the wall time
+ *
+ * Build and run (from the repository root):
+ * @code
+ *   g++ -std=c++20 -O2 -march=native -I. bench/fastlogger_bench_throughput.cpp -o fastlogger_bench_throughput -pthread
+ *   ./fastlogger_bench_throughput [maxThreads] [messagesPerThread] [logsDir]
+ * @endcode
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "LogManager.hpp"
+
+namespace {
+  using namespace SNJ;
+  using Clock = std::chrono::steady_clock;
+
+  double cpuSeconds(clockid_t __clock) {
+    timespec time{};
+    clock_gettime(__clock, &time);
+    return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_nsec) * 1e-9;
+  }
+
+  /**
+   * @brief Forwards to the sink under test and counts what reaches it.
+   */
+  class CountingSink : public LogSink {
+   public:
+    explicit CountingSink(std::shared_ptr<LogSink> __sink) : _mSink(std::move(__sink)) {}
+
+    void Write(const char* __data, std::size_t __size) override {
+      _mSink->Write(__data, __size);
+      _mWritten.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Flush() override { _mSink->Flush(); }
+
+    void BeginPass() override { _mSink->BeginPass(); }
+
+    void Quiesce() override { _mSink->Quiesce(); }
+
+    std::uint64_t GetWritten() const { return _mWritten.load(std::memory_order_relaxed); }
+
+   private:
+    std::shared_ptr<LogSink>   _mSink;
+    std::atomic<std::uint64_t> _mWritten{0};
+  };
+
+  enum class SinkKind { FILE, TMPFS, NUL };
+
+  struct Scenario {
+    SinkKind    _mSink;
+    FlushPolicy _mFlushPolicy;
+    const char* _mName;
+  };
+
+  constexpr Scenario kScenarios[] = {
+      {SinkKind::FILE, FlushPolicy::EVERY_RECORD, "file/flush-record"},
+      {SinkKind::FILE, FlushPolicy::EVERY_PASS, "file/flush-pass"},
+      {SinkKind::TMPFS, FlushPolicy::EVERY_RECORD, "tmpfs/flush-record"},
+      {SinkKind::TMPFS, FlushPolicy::EVERY_PASS, "tmpfs/flush-pass"},
+      {SinkKind::NUL, FlushPolicy::EVERY_PASS, "null"},
+  };
+
+  struct alignas(64) ProducerCounter {
+    std::atomic<std::uint64_t> _mProduced{0};
+    double                     _mCpuSeconds{0};
+  };
+
+  void runScenario(LogManager& __manager, const Scenario& __scenario, std::size_t __threads,
+                   std::uint64_t __messagesPerThread) {
+    static int sRun = 0;
+    std::string name   = "bench_throughput_" + std::to_string(sRun++);
+    auto        logger = __manager.CreateLogger(name);
+    logger->SetFlushPolicy(__scenario._mFlushPolicy);
+
+    std::shared_ptr<LogSink> target;
+    switch (__scenario._mSink) {
+      case SinkKind::FILE:
+        target = logger->GetFileSink();
+        break;
+      case SinkKind::TMPFS:
+        target = std::make_shared<FileSink>("/dev/shm/" + name + ".log");
+        break;
+      case SinkKind::NUL:
+        target = std::make_shared<NullSink>();
+        break;
+    }
+    logger->RemoveSink(logger->GetFileSink());
+    auto counter = std::make_shared<CountingSink>(target);
+    logger->AddSink(counter);
+
+    std::vector<ProducerCounter> producers(__threads);
+    std::vector<std::thread>     threads;
+    std::atomic<std::size_t>     ready{0};
+    std::atomic<bool>            go{false};
+    std::atomic<std::size_t>     finished{0};
+    for (std::size_t i = 0; i < __threads; ++i) {
+      threads.emplace_back([&, i]() {
+        ready.fetch_add(1);
+        while (!go.load(std::memory_order_acquire));
+        double cpuStart = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+        for (std::uint64_t seq = 0; seq < __messagesPerThread; ++seq) {
+          LOG_INFO(logger, "order {} qty {} px {}", seq, 100, 101.25);
+          producers[i]._mProduced.store(seq + 1, std::memory_order_relaxed);
+        }
+        producers[i]._mCpuSeconds = cpuSeconds(CLOCK_THREAD_CPUTIME_ID) - cpuStart;
+        finished.fetch_add(1, std::memory_order_release);
+      });
+    }
+    while (ready.load() != __threads);
+
+    double        processCpuStart = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID);
+    double        mainCpuStart    = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+    std::uint64_t total           = __threads * __messagesPerThread;
+    std::uint64_t maxLag          = 0;
+    auto          start           = Clock::now();
+    auto          producersDone   = start;
+    go.store(true, std::memory_order_release);
+
+    bool producing = true;
+    while (counter->GetWritten() < total) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      std::uint64_t produced = 0;
+      for (const auto& producer : producers) {
+        produced += producer._mProduced.load(std::memory_order_relaxed);
+      }
+      std::uint64_t written = counter->GetWritten();
+      maxLag                = std::max(maxLag, produced > written ? produced - written : 0);
+      if (producing && finished.load(std::memory_order_acquire) == __threads) {
+        producing     = false;
+        producersDone = Clock::now();
+      }
+      if (!producing && Clock::now() - producersDone > std::chrono::seconds(30)) break;  // Records were lost.
+    }
+    auto end = Clock::now();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    if (producing) producersDone = end;
+
+    double producerCpu = 0;
+    for (const auto& producer : producers) {
+      producerCpu += producer._mCpuSeconds;
+    }
+    double mainCpu     = cpuSeconds(CLOCK_THREAD_CPUTIME_ID) - mainCpuStart;
+    double consumerCpu = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID) - processCpuStart - producerCpu - mainCpu;
+    double seconds     = std::chrono::duration<double>(end - start).count();
+    double drainMs     = std::chrono::duration<double, std::milli>(end - producersDone).count();
+
+    std::printf("%-20s %7zu %12.0f %10llu %9.1f %8llu %9.3f %6.1f%%\n", __scenario._mName, __threads,
+                static_cast<double>(counter->GetWritten()) / seconds, static_cast<unsigned long long>(maxLag),
+                drainMs, static_cast<unsigned long long>(total - counter->GetWritten()), consumerCpu,
+                100.0 * consumerCpu / seconds);
+    std::fflush(stdout);
+
+    logger->RemoveSink(counter);
+    if (__scenario._mSink == SinkKind::TMPFS) {
+      std::remove(("/dev/shm/" + name + ".log").c_str());
+    }
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t maxThreads = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                                    : std::max<std::size_t>(2, std::thread::hardware_concurrency());
+  std::uint64_t messagesPerThread = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+  std::string   logsDir           = argc > 3 ? argv[3] : "bench_logs";
+
+  LogManager& manager = LogManager::getInstance(logsDir);
+  manager.StartLogging();
+
+  std::printf("%llu records per producer, logs in %s\n\n", static_cast<unsigned long long>(messagesPerThread),
+              logsDir.c_str());
+  std::printf("%-20s %7s %12s %10s %9s %8s %9s %7s\n", "sink", "threads", "msgs/s", "max lag", "drain ms", "lost",
+              "cons cpu", "of wall");
+  for (const Scenario& scenario : kScenarios) {
+    for (std::size_t threads = 1; threads <= maxThreads; threads *= 2) {
+      runScenario(manager, scenario, threads, messagesPerThread);
+    }
+  }
+  manager.StopLogging();
+  return 0;
+}